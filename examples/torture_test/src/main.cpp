@@ -63,16 +63,34 @@ void setup_io_pins(EventLoop &event_loop) {
   // create an interrupt that always reports if PIN1 is rising
   event_loop.onInterrupt(INPUT_PIN1, RISING, std::bind(reporter, INPUT_PIN1));
 
-  // every 9s, toggle reporting PIN2 falling edge
-  event_loop.onRepeat(9000, [&event_loop, &reporter]() {
-    if (ire2==nullptr) {
-      ire2 = event_loop.onInterrupt(INPUT_PIN2, FALLING, std::bind(reporter, INPUT_PIN2));
+  // every 9s, remove the PIN2 falling edge interrupt or add it back
+  EventLoop* loop = &event_loop;
+  auto add_ire2 = [loop, reporter]() {
+    ire2 = loop->onInterrupt(INPUT_PIN2, FALLING,
+                             std::bind(reporter, INPUT_PIN2));
+  };
+  add_ire2();
+  event_loop.onRepeat(9000, [loop, add_ire2]() {
+    if (ire2 == nullptr) {
+      add_ire2();
     } else {
-      ire2->remove();
+      ire2->remove(loop);
       ire2 = nullptr;
     }
   });
 
+  // every 2s, toggle reporting PIN2 while the interrupt is attached
+  event_loop.onRepeat(2000, []() {
+    if (ire2 == nullptr) {
+      return;
+    }
+    if (ire2->isEnabled()) {
+      ire2->disable();
+    } else {
+      ire2->enable();
+    }
+  });
+
 }
 
 void setup_serial(EventLoop &event_loop) {
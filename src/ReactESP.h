@@ -3,8 +3,16 @@
 
 #include <Arduino.h>
 
+#include "channel.h"
+#include "cyclic_executive.h"
+#include "dataflow.h"
 #include "event_loop.h"
 #include "events.h"
+#include "observable.h"
+#include "operators.h"
+#include "sampling.h"
+#include "static_schedule.h"
+#include "task_graph.h"
 
 #include <functional>
 
@@ -0,0 +1,168 @@
+#include "allocation_check.h"
+
+#ifdef REACTESP_ALLOCATION_CHECK
+
+#include <Arduino.h>
+#include <freertos/task.h>
+
+#include <cstdlib>
+#include <new>
+
+namespace reactesp {
+
+namespace {
+
+// The task that owns the currently armed guards and the guard nesting depth
+volatile TaskHandle_t guarded_task = nullptr;
+volatile int guard_depth = 0;
+volatile uint32_t violation_count = 0;
+AllocationGuard::ViolationHandler violation_handler = nullptr;
+
+void check_allocation(std::size_t size) {
+  if (guard_depth > 0 && xTaskGetCurrentTaskHandle() == guarded_task) {
+    violation_count = violation_count + 1;
+    // Report explicitly rather than with assert(), which is compiled out
+    // with NDEBUG.
+    if (violation_handler == nullptr) {
+      abort();
+    }
+    violation_handler(size);
+  }
+}
+
+void* unchecked_alloc(std::size_t size) {
+  return malloc(size == 0 ? 1 : size);
+}
+
+void* checked_alloc(std::size_t size) {
+  check_allocation(size);
+  void* ptr = unchecked_alloc(size);
+  if (ptr == nullptr) {
+    abort();
+  }
+  return ptr;
+}
+
+#ifdef __cpp_aligned_new
+
+// Over-allocate with malloc() and keep the original pointer just below the
+// aligned block, so that the heap of the platform is used as is.
+void* unchecked_aligned_alloc(std::size_t size, std::align_val_t alignment) {
+  const std::size_t align = static_cast<std::size_t>(alignment);
+  void* raw = malloc(size + align + sizeof(void*));
+  if (raw == nullptr) {
+    return nullptr;
+  }
+  const uintptr_t start = reinterpret_cast<uintptr_t>(raw) + sizeof(void*);
+  void** ptr = reinterpret_cast<void**>((start + align - 1) & ~(align - 1));
+  ptr[-1] = raw;
+  return ptr;
+}
+
+void aligned_free(void* ptr) {
+  if (ptr != nullptr) {
+    free(static_cast<void**>(ptr)[-1]);
+  }
+}
+
+void* checked_aligned_alloc(std::size_t size, std::align_val_t alignment) {
+  check_allocation(size);
+  void* ptr = unchecked_aligned_alloc(size, alignment);
+  if (ptr == nullptr) {
+    abort();
+  }
+  return ptr;
+}
+
+#endif  // __cpp_aligned_new
+
+}  // namespace
+
+AllocationGuard::AllocationGuard(bool armed) : armed(armed) {
+  if (armed) {
+    guarded_task = xTaskGetCurrentTaskHandle();
+    guard_depth = guard_depth + 1;
+  }
+}
+
+AllocationGuard::~AllocationGuard() {
+  if (armed) {
+    guard_depth = guard_depth - 1;
+  }
+}
+
+uint32_t AllocationGuard::getViolationCount() { return violation_count; }
+
+void AllocationGuard::setViolationHandler(ViolationHandler handler) {
+  violation_handler = handler;
+}
+
+}  // namespace reactesp
+
+void* operator new(std::size_t size) { return reactesp::checked_alloc(size); }
+
+void* operator new[](std::size_t size) {
+  return reactesp::checked_alloc(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+  reactesp::check_allocation(size);
+  return reactesp::unchecked_alloc(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+  reactesp::check_allocation(size);
+  return reactesp::unchecked_alloc(size);
+}
+
+void operator delete(void* ptr) noexcept { free(ptr); }
+void operator delete[](void* ptr) noexcept { free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { free(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { free(ptr); }
+
+#ifdef __cpp_aligned_new
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+  return reactesp::checked_aligned_alloc(size, alignment);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+  return reactesp::checked_aligned_alloc(size, alignment);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment,
+                   const std::nothrow_t&) noexcept {
+  reactesp::check_allocation(size);
+  return reactesp::unchecked_aligned_alloc(size, alignment);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment,
+                     const std::nothrow_t&) noexcept {
+  reactesp::check_allocation(size);
+  return reactesp::unchecked_aligned_alloc(size, alignment);
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept {
+  reactesp::aligned_free(ptr);
+}
+void operator delete[](void* ptr, std::align_val_t) noexcept {
+  reactesp::aligned_free(ptr);
+}
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept {
+  reactesp::aligned_free(ptr);
+}
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept {
+  reactesp::aligned_free(ptr);
+}
+void operator delete(void* ptr, std::align_val_t,
+                     const std::nothrow_t&) noexcept {
+  reactesp::aligned_free(ptr);
+}
+void operator delete[](void* ptr, std::align_val_t,
+                       const std::nothrow_t&) noexcept {
+  reactesp::aligned_free(ptr);
+}
+
+#endif  // __cpp_aligned_new
+
+#endif  // REACTESP_ALLOCATION_CHECK
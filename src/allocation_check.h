@@ -0,0 +1,63 @@
+#ifndef REACTESP_SRC_ALLOCATION_CHECK_H_
+#define REACTESP_SRC_ALLOCATION_CHECK_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace reactesp {
+
+#ifdef REACTESP_ALLOCATION_CHECK
+
+/**
+ * @brief Scope guard that forbids heap allocations by the current task.
+ *
+ * While an armed guard is alive, any call to the global operator new from the
+ * task that created the guard increments the violation counter and calls the
+ * violation handler, which aborts by default. All replaceable forms of
+ * operator new are checked, including the sized and aligned ones.
+ * Allocations made by other tasks are not affected.
+ */
+class AllocationGuard {
+ public:
+  typedef void (*ViolationHandler)(size_t size);
+
+  explicit AllocationGuard(bool armed);
+  ~AllocationGuard();
+
+  AllocationGuard(const AllocationGuard&) = delete;
+  AllocationGuard& operator=(const AllocationGuard&) = delete;
+
+  /**
+   * @brief Return the number of allocations made inside an armed guard.
+   */
+  static uint32_t getViolationCount();
+
+  /**
+   * @brief Set the function called for each allocation inside a guard.
+   *
+   * The handler receives the requested size. If it returns, the allocation
+   * proceeds. Pass nullptr to restore the default, which calls abort().
+   */
+  static void setViolationHandler(ViolationHandler handler);
+
+ private:
+  const bool armed;
+};
+
+#else
+
+class AllocationGuard {
+ public:
+  typedef void (*ViolationHandler)(size_t size);
+
+  explicit AllocationGuard(bool armed) {}
+
+  static uint32_t getViolationCount() { return 0; }
+  static void setViolationHandler(ViolationHandler handler) {}
+};
+
+#endif  // REACTESP_ALLOCATION_CHECK
+
+}  // namespace reactesp
+
+#endif  // REACTESP_SRC_ALLOCATION_CHECK_H_
@@ -0,0 +1,77 @@
+#ifndef REACTESP_SRC_BOUNDED_QUEUE_H_
+#define REACTESP_SRC_BOUNDED_QUEUE_H_
+
+#include <stddef.h>
+
+#include <vector>
+
+namespace reactesp {
+
+/**
+ * @brief Fixed-capacity FIFO queue backed by a ring buffer
+ *
+ * The storage is allocated once at construction; pushing and popping never
+ * allocate. The queue is not synchronized.
+ */
+template <typename T>
+class BoundedQueue {
+ public:
+  /**
+   * @brief Construct a new BoundedQueue object
+   *
+   * @param capacity Maximum number of items in the queue
+   */
+  explicit BoundedQueue(size_t capacity)
+      : items(capacity > 0 ? capacity : 1) {}
+
+  /**
+   * @brief Append an item to the end of the queue
+   *
+   * @return false if the queue is full
+   */
+  bool push(const T& item) {
+    if (full()) {
+      return false;
+    }
+    items[(head + count) % items.size()] = item;
+    count++;
+    if (count > max_size) {
+      max_size = count;
+    }
+    return true;
+  }
+
+  /**
+   * @brief Remove the item at the front of the queue
+   */
+  void pop() {
+    if (count == 0) {
+      return;
+    }
+    head = (head + 1) % items.size();
+    count--;
+  }
+
+  T& front() { return items[head]; }
+  const T& front() const { return items[head]; }
+
+  size_t size() const { return count; }
+  size_t capacity() const { return items.size(); }
+  bool empty() const { return count == 0; }
+  bool full() const { return count == items.size(); }
+
+  /**
+   * @brief Return the highest number of items the queue has held
+   */
+  size_t getMaxSize() const { return max_size; }
+
+ private:
+  std::vector<T> items;
+  size_t head = 0;
+  size_t count = 0;
+  size_t max_size = 0;
+};
+
+}  // namespace reactesp
+
+#endif  // REACTESP_SRC_BOUNDED_QUEUE_H_
@@ -0,0 +1,177 @@
+#ifndef REACTESP_SRC_CHANNEL_H_
+#define REACTESP_SRC_CHANNEL_H_
+
+#include <functional>
+#include <vector>
+
+#include "critical_section.h"
+#include "event_loop.h"
+#include "events.h"
+
+namespace reactesp {
+
+template <typename T>
+class ReceiveEvent;
+
+/**
+ * @brief Bounded channel for passing items to the event loop
+ *
+ * Items can be sent from interrupt handlers, other tasks and event
+ * callbacks. Each item is copied once into the channel storage, inside a
+ * short critical section, and handed to the receiver in place. The storage
+ * is allocated at construction; sending and receiving never allocate.
+ */
+template <typename T>
+class Channel {
+  friend class ReceiveEvent<T>;
+
+ public:
+  /**
+   * @brief Construct a new Channel object
+   *
+   * @param capacity Maximum number of items in the channel
+   */
+  explicit Channel(size_t capacity) : items(capacity > 0 ? capacity : 1) {}
+
+  Channel(const Channel&) = delete;
+  Channel& operator=(const Channel&) = delete;
+
+  /**
+   * @brief Send an item to the channel
+   *
+   * Safe to call from interrupt handlers and other tasks.
+   *
+   * @return false if the channel was full and the item was dropped
+   */
+  bool send(const T& item) {
+    lock.enter();
+    if (count == items.size()) {
+      dropped++;
+      lock.exit();
+      return false;
+    }
+    items[(head + count) % items.size()] = item;
+    count++;
+    ReceiveEvent<T>* event = receiver;
+    lock.exit();
+    if (event != nullptr) {
+      event->trigger();
+    }
+    return true;
+  }
+
+  size_t size() const { return count; }
+  size_t capacity() const { return items.size(); }
+
+  /**
+   * @brief Return the number of items dropped because the channel was full
+   */
+  uint32_t getDroppedCount() const { return dropped; }
+
+ protected:
+  std::vector<T> items;
+  size_t head = 0;
+  volatile size_t count = 0;
+  volatile uint32_t dropped = 0;
+  ReceiveEvent<T>* receiver = nullptr;
+  CriticalSection lock;
+};
+
+/**
+ * @brief Event that delivers the items of a Channel to a callback
+ *
+ * The event is triggered by the channel when items are sent and is never
+ * polled. The callback receives the available items in contiguous batches
+ * of at most max_batch items. The items are only valid during the callback.
+ */
+template <typename T>
+class ReceiveEvent : public TriggeredEvent {
+ public:
+  using receive_callback = std::function<void(const T* items, size_t count)>;
+
+  /**
+   * @brief Construct a new ReceiveEvent object
+   *
+   * @param channel Channel to receive from
+   * @param callback Callback receiving batches of items
+   * @param max_batch Maximum number of items per callback call. If more
+   *   items are available, the rest are delivered on the next tick.
+   */
+  ReceiveEvent(Channel<T>& channel, receive_callback callback,
+               size_t max_batch)
+      : TriggeredEvent(nullptr),
+        channel(channel),
+        receive(callback),
+        max_batch(max_batch > 0 ? max_batch : 1) {}
+
+  void add(EventLoop* event_loop) override {
+    TriggeredEvent::add(event_loop);
+    channel.lock.enter();
+    channel.receiver = this;
+    const bool has_items = channel.count > 0;
+    channel.lock.exit();
+    if (has_items) {
+      trigger();
+    }
+  }
+
+  void remove(EventLoop* event_loop) override {
+    channel.lock.enter();
+    if (channel.receiver == this) {
+      channel.receiver = nullptr;
+    }
+    channel.lock.exit();
+    TriggeredEvent::remove(event_loop);
+  }
+
+  void tick(EventLoop* event_loop) override {
+    channel.lock.enter();
+    const size_t head = channel.head;
+    const size_t available = channel.count;
+    channel.lock.exit();
+
+    // deliver the items in place; at most two calls if the batch wraps
+    // around the end of the ring buffer
+    const size_t n = available < max_batch ? available : max_batch;
+    const size_t capacity = channel.items.size();
+    const size_t first = n < capacity - head ? n : capacity - head;
+    if (first > 0) {
+      receive(&channel.items[head], first);
+    }
+    if (n > first) {
+      receive(&channel.items[0], n - first);
+    }
+
+    channel.lock.enter();
+    channel.head = (head + n) % capacity;
+    channel.count -= n;
+    const bool has_more = channel.count > 0;
+    channel.lock.exit();
+    if (has_more) {
+      trigger();
+    }
+  }
+
+  using EventInterface::add;
+  using EventInterface::remove;
+  using EventInterface::tick;
+
+ private:
+  Channel<T>& channel;
+  const receive_callback receive;
+  const size_t max_batch;
+};
+
+template <typename T>
+ReceiveEvent<T>* EventLoop::onReceive(
+    Channel<T>& channel,
+    std::function<void(const T* items, size_t count)> callback,
+    size_t max_batch) {
+  auto* rre = new ReceiveEvent<T>(channel, callback, max_batch);
+  rre->add(this);
+  return rre;
+}
+
+}  // namespace reactesp
+
+#endif  // REACTESP_SRC_CHANNEL_H_
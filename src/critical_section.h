@@ -0,0 +1,51 @@
+#ifndef REACTESP_SRC_CRITICAL_SECTION_H_
+#define REACTESP_SRC_CRITICAL_SECTION_H_
+
+#include <Arduino.h>
+
+namespace reactesp {
+
+/**
+ * @brief Short critical section usable from tasks and interrupt handlers
+ *
+ * On ESP32, this is a spinlock-protected critical section that is safe on
+ * both cores. Elsewhere, interrupts are disabled for the duration and the
+ * previous interrupt level is restored on exit, so a critical section
+ * entered with interrupts already disabled leaves them disabled.
+ */
+class CriticalSection {
+ public:
+  void ICACHE_RAM_ATTR enter() {
+#ifdef ESP32
+    portENTER_CRITICAL_SAFE(&mux);
+#else
+    const uint32_t level = xt_rsil(15);
+    if (depth++ == 0) {
+      saved_level = level;
+    }
+#endif
+  }
+
+  void ICACHE_RAM_ATTR exit() {
+#ifdef ESP32
+    portEXIT_CRITICAL_SAFE(&mux);
+#else
+    if (--depth == 0) {
+      xt_wsr_ps(saved_level);
+    }
+#endif
+  }
+
+ private:
+#ifdef ESP32
+  portMUX_TYPE mux = portMUX_INITIALIZER_UNLOCKED;
+#else
+  // processor state before the outermost enter()
+  uint32_t saved_level = 0;
+  uint8_t depth = 0;
+#endif
+};
+
+}  // namespace reactesp
+
+#endif  // REACTESP_SRC_CRITICAL_SECTION_H_
@@ -0,0 +1,90 @@
+#include "cyclic_executive.h"
+
+namespace reactesp {
+
+bool CyclicExecutive::addTask(react_callback callback, uint16_t period_frames,
+                              uint16_t offset) {
+  if (isRunning() || period_frames == 0 ||
+      minor_frames % period_frames != 0 || offset >= period_frames) {
+    return false;
+  }
+  tasks.push_back({callback, period_frames, offset});
+  return true;
+}
+
+void CyclicExecutive::buildFrameTable() {
+  frame_start.assign(minor_frames + 1, 0);
+  // count the tasks of each frame
+  for (const Task& task : tasks) {
+    for (uint32_t f = task.offset; f < minor_frames; f += task.period_frames) {
+      frame_start[f + 1]++;
+    }
+  }
+  for (uint32_t f = 0; f < minor_frames; f++) {
+    frame_start[f + 1] += frame_start[f];
+  }
+  // fill in the task indices, preserving the order the tasks were added in
+  frame_tasks.resize(frame_start[minor_frames]);
+  std::vector<uint32_t> fill(frame_start.begin(), frame_start.end() - 1);
+  for (uint32_t i = 0; i < tasks.size(); i++) {
+    const Task& task = tasks[i];
+    for (uint32_t f = task.offset; f < minor_frames; f += task.period_frames) {
+      frame_tasks[fill[f]++] = i;
+    }
+  }
+}
+
+void CyclicExecutive::start(bool precise) {
+  if (isRunning()) {
+    return;
+  }
+  buildFrameTable();
+  frame = 0;
+  frame_due = micros64() + minor_frame_us;
+  base_timer =
+      event_loop->onRepeatMicros(minor_frame_us, [this]() { runFrame(); });
+  base_timer->setPrecise(precise);
+}
+
+void CyclicExecutive::stop() {
+  if (!isRunning()) {
+    return;
+  }
+  base_timer->remove(event_loop);
+  base_timer = nullptr;
+}
+
+void CyclicExecutive::runFrame() {
+  const uint64_t frame_begin = micros64();
+  // The base timer silently resynchronizes after lagging, so missed frames
+  // are detected from the time elapsed since the current frame was due.
+  if (frame_begin >= frame_due + minor_frame_us) {
+    const uint64_t missed = (frame_begin - frame_due) / minor_frame_us;
+    missed_frame_count += missed;
+    overrun_count += missed;
+    frame = (frame + missed) % minor_frames;
+    frame_count += missed;
+    // the base timer restarts its period from now
+    frame_due = frame_begin;
+  }
+  frame_due += minor_frame_us;
+  for (uint32_t i = frame_start[frame]; i < frame_start[frame + 1]; i++) {
+    tasks[frame_tasks[i]].callback();
+  }
+  const uint64_t duration = micros64() - frame_begin;
+  const uint32_t duration32 =
+      duration > UINT32_MAX ? UINT32_MAX : (uint32_t)duration;
+  if (duration32 > max_frame_duration) {
+    max_frame_duration = duration32;
+  }
+  if (duration > minor_frame_us) {
+    overrun_count++;
+    if (overrun_cb) {
+      overrun_cb(frame, duration32);
+    }
+  }
+  frame = (frame + 1) % minor_frames;
+  frame_count++;
+}
+
+}  // namespace reactesp
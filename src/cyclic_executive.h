@@ -0,0 +1,143 @@
+#ifndef REACTESP_SRC_CYCLIC_EXECUTIVE_H_
+#define REACTESP_SRC_CYCLIC_EXECUTIVE_H_
+
+#include <functional>
+#include <vector>
+
+#include "event_loop.h"
+#include "events.h"
+
+namespace reactesp {
+
+using overrun_callback =
+    std::function<void(uint16_t frame, uint32_t duration_us)>;
+
+/**
+ * @brief Time-triggered cyclic executive
+ *
+ * A major frame is divided into a fixed number of minor frames of equal
+ * length. Each minor frame has a precomputed list of tasks, and a single
+ * repeating event of the event loop runs the list of the current minor
+ * frame, so the dispatch cost per frame does not depend on the number of
+ * tasks in other frames. Tasks with harmonic rates are added with
+ * addTask(); arbitrary frame assignments can be made with addToFrame().
+ *
+ * The base timer is a regular timed event, so the executive coexists with
+ * other events of the loop. With precise timing (the default) and
+ * EventLoop::tickBlocking(), the frames start within a few microseconds of
+ * their due time.
+ *
+ * A frame whose tasks run longer than the minor frame length is an
+ * overrun. Overruns are counted and reported to an optional callback.
+ * Frames that could not start on time because the loop was busy are
+ * detected from the frame start times. They are skipped, so that the
+ * following frames stay in phase, and counted as overruns too.
+ */
+class CyclicExecutive {
+ public:
+  /**
+   * @brief Construct a new CyclicExecutive object
+   *
+   * @param event_loop Event loop running the executive
+   * @param minor_frame_us Length of a minor frame, in microseconds
+   * @param minor_frames Number of minor frames in a major frame
+   */
+  CyclicExecutive(EventLoop* event_loop, uint64_t minor_frame_us,
+                  uint16_t minor_frames)
+      : event_loop(event_loop),
+        minor_frame_us(minor_frame_us),
+        minor_frames(minor_frames > 0 ? minor_frames : 1) {}
+  ~CyclicExecutive() { stop(); }
+
+  CyclicExecutive(const CyclicExecutive&) = delete;
+  CyclicExecutive& operator=(const CyclicExecutive&) = delete;
+
+  /**
+   * @brief Add a task that runs every period_frames minor frames
+   *
+   * @param callback Task function
+   * @param period_frames Task period in minor frames. Must divide the
+   *   number of minor frames in a major frame.
+   * @param offset Index of the first minor frame the task runs in. Must be
+   *   less than period_frames.
+   * @return false if the period is not harmonic with the major frame, the
+   *   offset is out of range or the executive is running
+   */
+  bool addTask(react_callback callback, uint16_t period_frames,
+               uint16_t offset = 0);
+
+  /**
+   * @brief Add a task that runs once per major frame, in the given minor
+   *   frame
+   *
+   * @return false if the frame is out of range or the executive is running
+   */
+  bool addToFrame(uint16_t frame, react_callback callback) {
+    return addTask(callback, minor_frames, frame);
+  }
+
+  /**
+   * @brief Build the frame table and start the base timer
+   *
+   * @param precise Use the precise timing mode of the base timer (see
+   *   TimedEvent::setPrecise())
+   */
+  void start(bool precise = true);
+  /**
+   * @brief Stop the base timer. The frame table is kept and the executive
+   *   can be restarted from frame 0.
+   */
+  void stop();
+  bool isRunning() const { return base_timer != nullptr; }
+
+  void onOverrun(overrun_callback callback) { overrun_cb = callback; }
+
+  uint16_t getCurrentFrame() const { return frame; }
+  uint64_t getFrameCount() const { return frame_count; }
+  /**
+   * @brief Return the number of overruns, including missed frames
+   */
+  uint32_t getOverrunCount() const { return overrun_count; }
+  /**
+   * @brief Return the number of frames skipped because they could not
+   *   start on time
+   */
+  uint32_t getMissedFrameCount() const { return missed_frame_count; }
+  /**
+   * @brief Return the longest frame execution time, in microseconds
+   */
+  uint32_t getMaxFrameDuration() const { return max_frame_duration; }
+
+ protected:
+  struct Task {
+    react_callback callback;
+    uint16_t period_frames;
+    uint16_t offset;
+  };
+
+  EventLoop* event_loop;
+  const uint64_t minor_frame_us;
+  const uint16_t minor_frames;
+  std::vector<Task> tasks;
+  // Frame table: the tasks of minor frame i are
+  // frame_tasks[frame_start[i]] ... frame_tasks[frame_start[i + 1] - 1]
+  std::vector<uint32_t> frame_start;
+  std::vector<uint32_t> frame_tasks;
+  RepeatEvent* base_timer = nullptr;
+  overrun_callback overrun_cb;
+
+  uint16_t frame = 0;
+  // the time the current frame is due to start, in microseconds
+  uint64_t frame_due = 0;
+  uint64_t frame_count = 0;
+  uint32_t overrun_count = 0;
+  uint32_t missed_frame_count = 0;
+  uint32_t max_frame_duration = 0;
+
+  void buildFrameTable();
+  void runFrame();
+};
+
+}  // namespace reactesp
+
+#endif  // REACTESP_SRC_CYCLIC_EXECUTIVE_H_
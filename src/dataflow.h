@@ -0,0 +1,290 @@
+#ifndef REACTESP_SRC_DATAFLOW_H_
+#define REACTESP_SRC_DATAFLOW_H_
+
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+#include "bounded_queue.h"
+#include "event_loop.h"
+#include "events.h"
+
+namespace reactesp {
+
+/**
+ * @brief Throughput and queue statistics of a dataflow stage
+ */
+struct StageStats {
+  /// Number of times the stage was run by the event loop
+  uint32_t invocations = 0;
+  /// Number of input items processed
+  uint32_t items_processed = 0;
+  /// Number of output items produced
+  uint32_t items_emitted = 0;
+  /// Number of input items dropped because the input queue was full
+  uint32_t items_dropped = 0;
+  /// Total time spent processing, in microseconds
+  uint64_t busy_time = 0;
+};
+
+/**
+ * @brief Common base of all dataflow stages
+ *
+ * A stage is run by the event loop through a TriggeredEvent only when
+ * there is input to process; idle stages cost nothing. Destroying a stage
+ * disconnects it from the stages it is connected to; the other stages keep
+ * running.
+ */
+class StageBase {
+  template <typename>
+  friend class StageInput;
+  template <typename, typename>
+  friend class Stage;
+
+ public:
+  StageBase(EventLoop* event_loop) : event_loop(event_loop) {
+    runner = event_loop->onTrigger([this]() { run(); });
+  }
+  virtual ~StageBase() { runner->remove(event_loop); }
+
+  StageBase(const StageBase&) = delete;
+  StageBase& operator=(const StageBase&) = delete;
+
+  const StageStats& getStats() const { return stats; }
+
+  /**
+   * @brief Schedule the stage to run if it has pending input
+   */
+  virtual void resume() = 0;
+
+ protected:
+  virtual void run() = 0;
+  void schedule() { runner->trigger(); }
+  /**
+   * @brief Forget a connected stage that is being destroyed
+   */
+  virtual void unlink(StageBase* stage) = 0;
+
+  EventLoop* event_loop;
+  TriggeredEvent* runner;
+  StageStats stats;
+};
+
+/**
+ * @brief Stage that consumes items of type In from a bounded input queue
+ *
+ * Each invocation processes at most batch_size items. If more input
+ * remains, the stage is rescheduled, allowing other events to run in
+ * between batches.
+ */
+template <typename In>
+class StageInput : public StageBase {
+  template <typename, typename>
+  friend class Stage;
+
+ public:
+  /**
+   * @brief Construct a new StageInput object
+   *
+   * @param event_loop Event loop running the stage
+   * @param queue_size Capacity of the input queue
+   * @param batch_size Maximum number of items processed per invocation
+   */
+  StageInput(EventLoop* event_loop, size_t queue_size, size_t batch_size)
+      : StageBase(event_loop),
+        queue(queue_size),
+        batch_size(batch_size > 0 ? batch_size : 1) {}
+  ~StageInput() override {
+    for (StageBase* stage : upstream) {
+      stage->unlink(this);
+    }
+  }
+
+  /**
+   * @brief Add an item to the input queue and schedule the stage
+   *
+   * Must be called from the event loop task.
+   *
+   * @return false if the queue was full and the item was dropped
+   */
+  bool push(const In& item) {
+    if (!queue.push(item)) {
+      stats.items_dropped++;
+      return false;
+    }
+    schedule();
+    return true;
+  }
+
+  bool full() const { return queue.full(); }
+  size_t getQueueDepth() const { return queue.size(); }
+  size_t getMaxQueueDepth() const { return queue.getMaxSize(); }
+
+  void resume() override {
+    if (!queue.empty()) {
+      schedule();
+    }
+  }
+
+ protected:
+  /**
+   * @brief Process a single item
+   *
+   * @return false if the item could not be processed because a downstream
+   * queue is full. The item is kept and retried once the downstream stage
+   * has made progress.
+   */
+  virtual bool process(const In& item) = 0;
+
+  void unlink(StageBase* stage) override {
+    upstream.erase(std::remove(upstream.begin(), upstream.end(), stage),
+                   upstream.end());
+  }
+
+  void run() override {
+    const uint64_t start = micros64();
+    size_t n = 0;
+    while (n < batch_size && !queue.empty()) {
+      if (!process(queue.front())) {
+        break;
+      }
+      queue.pop();
+      n++;
+    }
+    stats.invocations++;
+    stats.items_processed += n;
+    stats.busy_time += micros64() - start;
+    if (n == batch_size && !queue.empty()) {
+      schedule();
+    }
+    if (n > 0) {
+      // space was freed; let blocked upstream stages continue
+      for (StageBase* stage : upstream) {
+        stage->resume();
+      }
+    }
+  }
+
+  BoundedQueue<In> queue;
+  const size_t batch_size;
+  std::vector<StageBase*> upstream;
+};
+
+/**
+ * @brief Stage that transforms input items into output items
+ *
+ * The transform function receives an input item and a reference to an
+ * output item. It returns true if an output item was produced, which is
+ * then pushed to all connected downstream stages. Returning false allows
+ * filtering and aggregation (e.g. producing an average for every N
+ * inputs).
+ *
+ * @code
+ * Stage<int, float> average(&event_loop, 16, 8,
+ *     [](const int& in, float& out) { ... });
+ * SinkStage<float> publish(&event_loop, 4, 4,
+ *     [](const float& value) { ... });
+ * average.connect(publish);
+ * average.push(42);
+ * @endcode
+ */
+template <typename In, typename Out>
+class Stage : public StageInput<In> {
+ public:
+  using transform_function = std::function<bool(const In&, Out&)>;
+
+  /**
+   * @brief Construct a new Stage object
+   *
+   * @param event_loop Event loop running the stage
+   * @param queue_size Capacity of the input queue
+   * @param batch_size Maximum number of items processed per invocation
+   * @param transform Transform function
+   */
+  Stage(EventLoop* event_loop, size_t queue_size, size_t batch_size,
+        transform_function transform)
+      : StageInput<In>(event_loop, queue_size, batch_size),
+        transform(transform) {}
+  ~Stage() override {
+    for (StageInput<Out>* stage : downstream) {
+      stage->unlink(this);
+    }
+  }
+
+  /**
+   * @brief Connect the output of this stage to the input of another stage
+   *
+   * @return The downstream stage, to allow chaining
+   */
+  template <typename Next>
+  Next& connect(Next& next) {
+    StageInput<Out>& input = next;
+    downstream.push_back(&input);
+    input.upstream.push_back(this);
+    return next;
+  }
+
+ protected:
+  bool process(const In& item) override {
+    for (StageInput<Out>* stage : downstream) {
+      if (stage->full()) {
+        return false;
+      }
+    }
+    Out output;
+    if (transform(item, output)) {
+      this->stats.items_emitted++;
+      for (StageInput<Out>* stage : downstream) {
+        stage->push(output);
+      }
+    }
+    return true;
+  }
+
+  void unlink(StageBase* stage) override {
+    downstream.erase(
+        std::remove_if(downstream.begin(), downstream.end(),
+                       [stage](StageInput<Out>* next) {
+                         return static_cast<StageBase*>(next) == stage;
+                       }),
+        downstream.end());
+    StageInput<In>::unlink(stage);
+  }
+
+  transform_function transform;
+  std::vector<StageInput<Out>*> downstream;
+};
+
+/**
+ * @brief Terminal stage that consumes items without producing output
+ */
+template <typename In>
+class SinkStage : public StageInput<In> {
+ public:
+  using consumer_function = std::function<void(const In&)>;
+
+  /**
+   * @brief Construct a new SinkStage object
+   *
+   * @param event_loop Event loop running the stage
+   * @param queue_size Capacity of the input queue
+   * @param batch_size Maximum number of items processed per invocation
+   * @param consumer Function called for each input item
+   */
+  SinkStage(EventLoop* event_loop, size_t queue_size, size_t batch_size,
+            consumer_function consumer)
+      : StageInput<In>(event_loop, queue_size, batch_size),
+        consumer(consumer) {}
+
+ protected:
+  bool process(const In& item) override {
+    consumer(item);
+    return true;
+  }
+
+  consumer_function consumer;
+};
+
+}  // namespace reactesp
+
+#endif  // REACTESP_SRC_DATAFLOW_H_
@@ -22,6 +22,17 @@ void EventLoop::tickTimed() {
     const uint64_t trigger_t = top->getTriggerTimeMicros();
     if (now >= trigger_t) {
       timed_queue.pop();
+      timed_lateness.record(now - trigger_t);
+      load_window_lateness.record(now - trigger_t);
+      if (load_stats.overloaded && shed(top)) {
+        // re-arm after now, so that the loop ends even if the interval is
+        // zero
+        const uint64_t next_trigger_t =
+            now + std::max<uint64_t>(top->interval, 1);
+        top->last_trigger_time = next_trigger_t - top->interval;
+        timed_queue.push(top);
+        continue;
+      }
       top->tick(this);
       timed_event_counter++;
     } else {
@@ -33,19 +44,403 @@ void EventLoop::tickTimed() {
 
 void EventLoop::tickUntimed() {
   xSemaphoreTakeRecursive(untimed_list_mutex_, portMAX_DELAY);
-  for (UntimedEvent* re : this->untimed_list) {
+  // callbacks may add events to the list or take their own event out of it
+  for (size_t i = 0; i < this->untimed_list.size(); i++) {
+    UntimedEvent* re = this->untimed_list[i];
     re->tick(this);
     untimed_event_counter++;
+    if (i < this->untimed_list.size() && this->untimed_list[i] != re) {
+      // the next event has moved into this slot
+      i--;
+    }
+  }
+  xSemaphoreGiveRecursive(untimed_list_mutex_);
+}
+
+void ICACHE_RAM_ATTR EventLoop::pushPending(TriggeredEvent* event) {
+  TriggeredEvent* head = pending_head.load();
+  do {
+    event->next_pending = head;
+  } while (!pending_head.compare_exchange_weak(head, event));
+}
+
+void EventLoop::tickTriggered() {
+  TriggeredEvent* head = pending_head.exchange(nullptr);
+  if (head == nullptr) {
+    return;
+  }
+  // the stack is in LIFO order; reverse it to run the events in the order
+  // they were triggered
+  TriggeredEvent* ordered = nullptr;
+  while (head != nullptr) {
+    TriggeredEvent* next = head->next_pending;
+    head->next_pending = ordered;
+    ordered = head;
+    head = next;
+  }
+  while (ordered != nullptr) {
+    TriggeredEvent* event = ordered;
+    // read the link before clearing the pending flag: once the flag is
+    // cleared, the event may be triggered and relinked at any time
+    ordered = event->next_pending;
+    event->pending.store(false);
+    if (!event->isEnabled()) {
+      delete event;
+      continue;
+    }
+    event->tick(this);
+    triggered_event_counter++;
+  }
+}
+
+void EventLoop::tickRTOS() {
+  xSemaphoreTakeRecursive(rtos_event_list_mutex_, portMAX_DELAY);
+  if (queue_set != nullptr) {
+    // Drain the queue set. Each entry stands for one item or give; count
+    // them per event so that the events consume exactly one item per entry
+    // and the set cannot fill up.
+    QueueSetMemberHandle_t member;
+    while ((member = xQueueSelectFromSet(queue_set, 0)) != nullptr) {
+      handleSetMember(member);
+    }
+  }
+  for (RTOSEvent* event : rtos_event_list) {
+    if (event->poll()) {
+      rtos_event_counter++;
+    }
+  }
+  xSemaphoreGiveRecursive(rtos_event_list_mutex_);
+}
+
+void EventLoop::handleSetMember(QueueSetMemberHandle_t member) {
+  if (member == wakeup_semaphore) {
+    xSemaphoreTake(wakeup_semaphore, 0);
+    return;
+  }
+  xSemaphoreTakeRecursive(rtos_event_list_mutex_, portMAX_DELAY);
+  for (RTOSEvent* event : rtos_event_list) {
+    if (event->queue_set_slots != 0 && event->getSetMember() == member) {
+      event->signalled++;
+      break;
+    }
+  }
+  xSemaphoreGiveRecursive(rtos_event_list_mutex_);
+}
+
+void ICACHE_RAM_ATTR EventLoop::wake() {
+  if (!waiting.load() || wakeup_semaphore == nullptr) {
+    return;
+  }
+#ifdef ESP32
+  if (xPortInIsrContext()) {
+    BaseType_t higher_priority_task_woken = pdFALSE;
+    xSemaphoreGiveFromISR(wakeup_semaphore, &higher_priority_task_woken);
+    if (higher_priority_task_woken) {
+      portYIELD_FROM_ISR();
+    }
+    return;
   }
+#endif
+  xSemaphoreGive(wakeup_semaphore);
+}
+
+void EventLoop::createQueueSet() {
+  queue_set = xQueueCreateSet(REACTESP_QUEUE_SET_LENGTH);
+  wakeup_semaphore = xSemaphoreCreateBinary();
+  xQueueAddToSet(wakeup_semaphore, queue_set);
+  // the binary wakeup semaphore has at most one entry in the set
+  queue_set_free = REACTESP_QUEUE_SET_LENGTH - 1;
+}
+
+void EventLoop::updateWakeLatency(int32_t latency) {
+  // Smoothed mean and mean deviation, as in TCP round-trip time estimation
+  const int32_t error = latency - wake_latency_mean;
+  wake_latency_mean += error / 8;
+  wake_latency_deviation += ((error < 0 ? -error : error) -
+                             wake_latency_deviation) / 4;
+  const int32_t margin = wake_latency_mean + 4 * wake_latency_deviation;
+  const int32_t max_margin = 2000 * portTICK_PERIOD_MS;
+  early_wake_margin = std::max<int32_t>(0, std::min(margin, max_margin));
+}
+
+void EventLoop::tickBlocking(uint32_t max_wait_ms) {
+  if (queue_set == nullptr) {
+    createQueueSet();
+  }
+
+  const bool wait_forever = max_wait_ms == UINT32_MAX;
+  uint64_t timeout = (uint64_t)1000 * (uint64_t)max_wait_ms;
+  bool has_deadline = !wait_forever;
+  xSemaphoreTakeRecursive(untimed_list_mutex_, portMAX_DELAY);
+  const bool has_untimed = !untimed_list.empty();
   xSemaphoreGiveRecursive(untimed_list_mutex_);
+  if (has_untimed) {
+    timeout = 0;
+  } else if (polled_rtos_events > 0) {
+    timeout = std::min<uint64_t>(timeout, 1000 * REACTESP_RTOS_POLL_MS);
+    has_deadline = true;
+  }
+  // trigger time of the next event if it is a precise one, otherwise zero
+  uint64_t precise_trigger_t = 0;
+  const uint64_t now = micros64();
+  xSemaphoreTakeRecursive(timed_queue_mutex_, portMAX_DELAY);
+  if (!timed_queue.empty()) {
+    const TimedEvent* top = timed_queue.top();
+    uint64_t trigger_t = top->getTriggerTimeMicros();
+    if (top->isEnabled() && top->isPrecise()) {
+      precise_trigger_t = trigger_t;
+      trigger_t -= std::min<uint64_t>(trigger_t, early_wake_margin);
+    }
+    timeout = trigger_t > now ? std::min(timeout, trigger_t - now) : 0;
+    has_deadline = true;
+  }
+  xSemaphoreGiveRecursive(timed_queue_mutex_);
+
+  const uint64_t tick_period = (uint64_t)1000 * portTICK_PERIOD_MS;
+  bool signalled = false;
+  if (timeout >= tick_period) {
+    waiting.store(true);
+    // a trigger that happened before the flag was set is seen here
+    if (pending_head.load() == nullptr) {
+      const TickType_t ticks =
+          has_deadline
+              ? (TickType_t)std::min<uint64_t>(timeout / tick_period,
+                                               portMAX_DELAY - 1)
+              : portMAX_DELAY;
+      QueueSetMemberHandle_t member = xQueueSelectFromSet(queue_set, ticks);
+      if (member != nullptr) {
+        handleSetMember(member);
+      }
+      signalled = member != nullptr;
+      if (member == nullptr && precise_trigger_t != 0) {
+        // timed out as planned; calibrate against the intended wake time
+        const int64_t latency = micros64() - (now + ticks * tick_period);
+        updateWakeLatency(
+            (int32_t)std::max<int64_t>(INT32_MIN,
+                                       std::min<int64_t>(INT32_MAX, latency)));
+      }
+    }
+    waiting.store(false);
+  }
+
+  // Spin if the precise deadline is close, unless other work woke the loop
+  // up; in that case, the next call will wait for the deadline again.
+  bool spun = false;
+  if (precise_trigger_t != 0 && !signalled &&
+      pending_head.load() == nullptr &&
+      precise_trigger_t <= micros64() + early_wake_margin + tick_period) {
+    while (micros64() < precise_trigger_t) {
+      // spin until the deadline
+    }
+    spun = true;
+  }
+  // after spinning, the precise event must not wait for the other phases
+  runTick(spun);
 }
 
-void EventLoop::tick() {
-  tickUntimed();
-  tickTimed();
+void EventLoop::addRTOSEvent(RTOSEvent* event) {
+  xSemaphoreTakeRecursive(rtos_event_list_mutex_, portMAX_DELAY);
+  if (queue_set == nullptr) {
+    createQueueSet();
+  }
+  QueueSetMemberHandle_t member = event->getSetMember();
+  if (member != nullptr) {
+    // As the loop is the only consumer and takes one item per set entry,
+    // the member never has more entries in the set than its length.
+    const size_t slots =
+        uxQueueMessagesWaiting(member) + uxQueueSpacesAvailable(member);
+    if (slots <= queue_set_free &&
+        xQueueAddToSet(member, queue_set) == pdPASS) {
+      event->queue_set_slots = slots;
+      queue_set_free -= slots;
+    }
+  }
+  if (event->queue_set_slots == 0) {
+    polled_rtos_events++;
+  }
+  rtos_event_list.push_back(event);
+  xSemaphoreGiveRecursive(rtos_event_list_mutex_);
+}
+
+void EventLoop::tick() { runTick(false); }
+
+void EventLoop::runTick(bool timed_first) {
+  const bool measure_load = overload_window != 0;
+  uint64_t tick_start = 0;
+  uint64_t dispatched_before = 0;
+  if (measure_load) {
+    tick_start = micros64();
+    dispatched_before =
+        timed_event_counter + triggered_event_counter + rtos_event_counter;
+  }
+  {
+    AllocationGuard allocation_guard(allocation_check_enabled);
+    if (timed_first) {
+      tickTimed();
+    }
+    tickUntimed();
+    tickTriggered();
+    tickRTOS();
+    tickTimed();
+  }
+  if (measure_load) {
+    updateLoad(tick_start, dispatched_before);
+  }
+  if (reclaim_low_water_percent != 0 && !allocation_check_enabled) {
+    reclaimCapacity();
+  }
   tick_counter++;
 }
 
+void EventLoop::enableOverloadDetection(uint32_t window_ms,
+                                        uint8_t high_percent,
+                                        uint8_t low_percent,
+                                        uint32_t max_lateness_us) {
+  overload_window = (uint64_t)1000 * window_ms;
+  overload_high_percent = high_percent;
+  overload_low_percent = low_percent;
+  overload_max_lateness = max_lateness_us;
+  load_window_start = micros64();
+  load_window_busy = 0;
+  load_window_lateness.reset();
+  load_stats.overloaded = false;
+}
+
+void EventLoop::updateLoad(uint64_t tick_start, uint64_t dispatched_before) {
+  const uint64_t now = micros64();
+  if (timed_event_counter + triggered_event_counter + rtos_event_counter !=
+      dispatched_before) {
+    load_window_busy += now - tick_start;
+  }
+  const uint64_t window = now - load_window_start;
+  if (window < overload_window) {
+    return;
+  }
+
+  const uint64_t utilization = load_window_busy * 100 / window;
+  load_stats.utilization_percent = utilization > 100 ? 100 : utilization;
+  load_stats.average_lateness = load_window_lateness.getAverage();
+  load_window_start = now;
+  load_window_busy = 0;
+  load_window_lateness.reset();
+
+  const bool late = overload_max_lateness != 0 &&
+                    load_stats.average_lateness > overload_max_lateness;
+  const bool recovered_lateness =
+      overload_max_lateness == 0 ||
+      load_stats.average_lateness <= overload_max_lateness / 2;
+  bool overloaded = load_stats.overloaded;
+  if (!overloaded) {
+    overloaded =
+        load_stats.utilization_percent >= overload_high_percent || late;
+  } else {
+    overloaded = load_stats.utilization_percent >= overload_low_percent ||
+                 !recovered_lateness;
+  }
+  if (overloaded == load_stats.overloaded) {
+    return;
+  }
+  load_stats.overloaded = overloaded;
+  if (overloaded) {
+    load_stats.overload_count++;
+  }
+  for (auto& callback : overload_callbacks) {
+    callback(load_stats);
+  }
+}
+
+bool EventLoop::shed(TimedEvent* event) {
+  if (!event->sheddable || !event->isRepeating()) {
+    return false;
+  }
+  if (shed_divisor != 0 && ++event->shed_phase >= shed_divisor) {
+    event->shed_phase = 0;
+    return false;
+  }
+  load_stats.shed_count++;
+  return true;
+}
+
+namespace {
+
+// Return true if the occupancy has been low for long enough. The low
+// flag is cleared whenever the occupancy is above the threshold; low_since
+// is the time it was last set.
+bool is_reclaimable(size_t size, size_t capacity, size_t reserved,
+                    uint8_t low_water_percent, uint64_t hold_time,
+                    uint64_t now, bool& low, uint64_t& low_since) {
+  if (capacity <= reserved ||
+      size * 100 > capacity * (size_t)low_water_percent) {
+    low = false;
+    return false;
+  }
+  if (!low) {
+    low = true;
+    low_since = now;
+    return false;
+  }
+  return now - low_since >= hold_time;
+}
+
+// Capacity to shrink a container to: twice its size, so that it does not
+// grow again as soon as an element is added, but not below the reserved
+// capacity
+size_t reclaim_capacity(size_t size, size_t reserved) {
+  return std::max(2 * size, reserved);
+}
+
+}  // namespace
+
+void EventLoop::reclaimCapacity() {
+  const uint64_t now = micros64();
+
+  xSemaphoreTakeRecursive(timed_queue_mutex_, portMAX_DELAY);
+  if (is_reclaimable(timed_queue.size(), timed_queue.capacity(),
+                     reserved_timed_events, reclaim_low_water_percent,
+                     reclaim_hold_time, now, timed_low_occupancy,
+                     timed_low_occupancy_since)) {
+    reclaimed_bytes += timed_queue.shrink(
+        reclaim_capacity(timed_queue.size(), reserved_timed_events));
+    timed_low_occupancy = false;
+  }
+  xSemaphoreGiveRecursive(timed_queue_mutex_);
+
+  xSemaphoreTakeRecursive(untimed_list_mutex_, portMAX_DELAY);
+  if (is_reclaimable(untimed_list.size(), untimed_list.capacity(),
+                     reserved_untimed_events, reclaim_low_water_percent,
+                     reclaim_hold_time, now, untimed_low_occupancy,
+                     untimed_low_occupancy_since)) {
+    reclaimed_bytes += shrink_vector(
+        untimed_list,
+        reclaim_capacity(untimed_list.size(), reserved_untimed_events));
+    untimed_low_occupancy = false;
+  }
+  xSemaphoreGiveRecursive(untimed_list_mutex_);
+}
+
+void EventLoop::setCapacityReclaim(uint8_t low_water_percent,
+                                   uint32_t hold_ms) {
+  reclaim_low_water_percent = std::min<uint8_t>(low_water_percent, 100);
+  reclaim_hold_time = (uint64_t)1000 * (uint64_t)hold_ms;
+  timed_low_occupancy = false;
+  untimed_low_occupancy = false;
+}
+
+void EventLoop::reserve(size_t timed_events, size_t untimed_events,
+                        size_t isr_events) {
+  xSemaphoreTakeRecursive(timed_queue_mutex_, portMAX_DELAY);
+  timed_queue.reserve(timed_events);
+  reserved_timed_events = timed_events;
+  xSemaphoreGiveRecursive(timed_queue_mutex_);
+  xSemaphoreTakeRecursive(untimed_list_mutex_, portMAX_DELAY);
+  untimed_list.reserve(untimed_events);
+  reserved_untimed_events = untimed_events;
+  xSemaphoreGiveRecursive(untimed_list_mutex_);
+  xSemaphoreTakeRecursive(isr_event_list_mutex_, portMAX_DELAY);
+  isr_event_list.reserve(isr_events);
+  xSemaphoreGiveRecursive(isr_event_list_mutex_);
+}
+
 DelayEvent* EventLoop::onDelay(uint32_t delay, react_callback callback) {
   auto* dre = new DelayEvent(delay, callback);
   dre->add(this);
@@ -71,12 +466,39 @@ RepeatEvent* EventLoop::onRepeatMicros(uint64_t interval,
   return rre;
 }
 
+PreciseRepeatEvent* EventLoop::onPreciseRepeat(uint32_t interval,
+                                               react_callback callback) {
+  auto* pre = new PreciseRepeatEvent(interval, callback);
+  pre->add(this);
+  return pre;
+}
+
+PreciseRepeatEvent* EventLoop::onPreciseRepeatMicros(uint64_t interval,
+                                                     react_callback callback) {
+  auto* pre = new PreciseRepeatEvent(interval, callback);
+  pre->add(this);
+  return pre;
+}
+
 StreamEvent* EventLoop::onAvailable(Stream& stream, react_callback callback) {
   auto* sre = new StreamEvent(stream, callback);
   sre->add(this);
   return sre;
 }
 
+StreamMuxEvent* EventLoop::onAvailableMux(uint16_t max_backoff) {
+  auto* sme = new StreamMuxEvent(max_backoff);
+  sme->add(this);
+  return sme;
+}
+
+WritableEvent* EventLoop::onWritable(Stream& stream, int min_space,
+                                     react_callback callback) {
+  auto* wre = new WritableEvent(stream, min_space, callback);
+  wre->add(this);
+  return wre;
+}
+
 ISREvent* EventLoop::onInterrupt(uint8_t pin_number, int mode,
                                  react_callback callback) {
   auto* isrre = new ISREvent(pin_number, mode, callback);
@@ -84,12 +506,76 @@ ISREvent* EventLoop::onInterrupt(uint8_t pin_number, int mode,
   return isrre;
 }
 
+BarrierEvent* EventLoop::onBarrier(uint32_t count, barrier_callback callback,
+                                   uint32_t timeout) {
+  auto* be = new BarrierEvent(count, callback, timeout);
+  be->add(this);
+  return be;
+}
+
+DescriptorTableEvent* EventLoop::onDescriptorTable(
+    const EventDescriptor* table, size_t count) {
+  auto* dte = new DescriptorTableEvent(table, count);
+  dte->add(this);
+  return dte;
+}
+
+PulseEvent* EventLoop::onPulse(uint8_t pin_number, uint32_t window_ms,
+                               pulse_callback callback, bool measure_width) {
+  auto* pe = new PulseEvent(pin_number, window_ms, callback, measure_width);
+  pe->add(this);
+  return pe;
+}
+
+EncoderEvent* EventLoop::onEncoder(uint8_t pin_a, uint8_t pin_b,
+                                   encoder_callback callback,
+                                   uint32_t notify_interval_us) {
+  auto* ee = new EncoderEvent(pin_a, pin_b, callback, notify_interval_us);
+  ee->add(this);
+  return ee;
+}
+
+PinGroupEvent* EventLoop::onPinGroup() {
+  auto* pge = new PinGroupEvent();
+  pge->add(this);
+  return pge;
+}
+
 TickEvent* EventLoop::onTick(react_callback callback) {
   auto* tre = new TickEvent(callback);
   tre->add(this);
   return tre;
 }
 
+TriggeredEvent* EventLoop::onTrigger(react_callback callback) {
+  auto* tre = new TriggeredEvent(callback);
+  tre->add(this);
+  return tre;
+}
+
+QueueEvent* EventLoop::onQueue(QueueHandle_t queue, react_callback callback) {
+  auto* qre = new QueueEvent(queue, callback);
+  qre->add(this);
+  return qre;
+}
+
+SemaphoreEvent* EventLoop::onSemaphore(SemaphoreHandle_t semaphore,
+                                       react_callback callback) {
+  auto* sre = new SemaphoreEvent(semaphore, callback);
+  sre->add(this);
+  return sre;
+}
+
+EventBitsEvent* EventLoop::onEventBits(EventGroupHandle_t event_group,
+                                       EventBits_t bits,
+                                       event_bits_callback callback,
+                                       bool clear_on_trigger) {
+  auto* ebre =
+      new EventBitsEvent(event_group, bits, callback, clear_on_trigger);
+  ebre->add(this);
+  return ebre;
+}
+
 void EventLoop::remove(TimedEvent* event) { event->remove(this); }
 
 void EventLoop::remove(UntimedEvent* event) {
@@ -111,6 +597,208 @@ void EventLoop::remove(ISREvent* event) {
   xSemaphoreGiveRecursive(this->isr_event_list_mutex_);
 }
 
+void EventLoop::remove(RTOSEvent* event) {
+  xSemaphoreTakeRecursive(this->rtos_event_list_mutex_, portMAX_DELAY);
+  auto it = std::find(this->rtos_event_list.begin(),
+                      this->rtos_event_list.end(), event);
+  if (it != this->rtos_event_list.end()) {
+    this->rtos_event_list.erase(it);
+    // Removal from the queue set fails if the member is not empty. In that
+    // case, its slots stay reserved.
+    if (event->queue_set_slots == 0) {
+      polled_rtos_events--;
+    } else if (xQueueRemoveFromSet(event->getSetMember(), queue_set) ==
+               pdPASS) {
+      queue_set_free += event->queue_set_slots;
+    }
+  }
+  delete event;
+  xSemaphoreGiveRecursive(this->rtos_event_list_mutex_);
+}
+
 void EventLoop::remove(Event* event) { event->remove(this); }
 
+namespace {
+
+// Snapshot blob layout (native byte order):
+//   header: magic (u16), version (u8), reserved (u8), entry count (u16),
+//           timed, untimed and tick counters (3 x u64)
+//   entry:  id (u16), flags (u8), remaining time (u64), interval (u64)
+const uint16_t kSnapshotMagic = 0x5245;
+const uint8_t kSnapshotVersion = 1;
+const size_t kSnapshotHeaderSize = 2 + 1 + 1 + 2 + 3 * 8;
+const size_t kSnapshotEntrySize = 2 + 1 + 8 + 8;
+const uint8_t kSnapshotFlagRepeating = 0x01;
+
+template <typename T>
+uint8_t* put(uint8_t* p, T value) {
+  memcpy(p, &value, sizeof(T));
+  return p + sizeof(T);
+}
+
+template <typename T>
+const uint8_t* get(const uint8_t* p, T& value) {
+  memcpy(&value, p, sizeof(T));
+  return p + sizeof(T);
+}
+
+}  // namespace
+
+size_t EventLoop::snapshotSchedule(uint8_t* buffer, size_t buffer_size) {
+  xSemaphoreTakeRecursive(timed_queue_mutex_, portMAX_DELAY);
+  const std::vector<TimedEvent*>& events = timed_queue.container();
+  size_t count = 0;
+  for (const TimedEvent* event : events) {
+    if (event->isEnabled() && event->getId() != 0) {
+      count++;
+    }
+  }
+  count = std::min<size_t>(count, UINT16_MAX);
+  const size_t size = kSnapshotHeaderSize + count * kSnapshotEntrySize;
+  if (buffer == nullptr || buffer_size < size) {
+    xSemaphoreGiveRecursive(timed_queue_mutex_);
+    return buffer == nullptr ? size : 0;
+  }
+
+  const uint64_t now = micros64();
+  uint8_t* p = buffer;
+  p = put<uint16_t>(p, kSnapshotMagic);
+  p = put<uint8_t>(p, kSnapshotVersion);
+  p = put<uint8_t>(p, 0);
+  p = put<uint16_t>(p, count);
+  p = put<uint64_t>(p, timed_event_counter);
+  p = put<uint64_t>(p, untimed_event_counter);
+  p = put<uint64_t>(p, tick_counter);
+  size_t written = 0;
+  for (const TimedEvent* event : events) {
+    if (written == count) {
+      break;
+    }
+    if (!event->isEnabled() || event->getId() == 0) {
+      continue;
+    }
+    const uint64_t trigger_time = event->getTriggerTimeMicros();
+    p = put<uint16_t>(p, event->getId());
+    p = put<uint8_t>(p, event->isRepeating() ? kSnapshotFlagRepeating : 0);
+    p = put<uint64_t>(p, trigger_time > now ? trigger_time - now : 0);
+    p = put<uint64_t>(p, event->interval);
+    written++;
+  }
+  xSemaphoreGiveRecursive(timed_queue_mutex_);
+  return size;
+}
+
+int EventLoop::restoreSchedule(const uint8_t* buffer, size_t buffer_size,
+                               uint64_t elapsed_us) {
+  if (buffer == nullptr || buffer_size < kSnapshotHeaderSize) {
+    return -1;
+  }
+  const uint8_t* p = buffer;
+  uint16_t magic;
+  uint8_t version;
+  uint8_t reserved;
+  uint16_t count;
+  uint64_t timed_count;
+  uint64_t untimed_count;
+  uint64_t tick_count;
+  p = get(p, magic);
+  p = get(p, version);
+  p = get(p, reserved);
+  p = get(p, count);
+  if (magic != kSnapshotMagic || version != kSnapshotVersion ||
+      buffer_size < kSnapshotHeaderSize + count * kSnapshotEntrySize) {
+    return -1;
+  }
+  p = get(p, timed_count);
+  p = get(p, untimed_count);
+  p = get(p, tick_count);
+
+  xSemaphoreTakeRecursive(timed_queue_mutex_, portMAX_DELAY);
+  timed_event_counter = timed_count;
+  untimed_event_counter = untimed_count;
+  tick_counter = tick_count;
+
+  const uint64_t now = micros64();
+  std::vector<TimedEvent*>& events = timed_queue.container();
+  // events already restored; each entry restores a different event, also
+  // when several events share an id
+  std::vector<bool> matched(events.size(), false);
+  int restored = 0;
+  for (uint16_t i = 0; i < count; i++) {
+    uint16_t id;
+    uint8_t flags;
+    uint64_t remaining;
+    uint64_t interval;
+    p = get(p, id);
+    p = get(p, flags);
+    p = get(p, remaining);
+    p = get(p, interval);
+
+    const bool repeating = (flags & kSnapshotFlagRepeating) != 0;
+    if (elapsed_us <= remaining) {
+      remaining -= elapsed_us;
+    } else if (repeating && interval != 0) {
+      // keep the phase: skip the periods missed while away
+      const uint64_t overdue = (elapsed_us - remaining) % interval;
+      remaining = overdue == 0 ? 0 : interval - overdue;
+    } else {
+      remaining = 0;
+    }
+
+    for (size_t j = 0; j < events.size(); j++) {
+      TimedEvent* event = events[j];
+      if (!matched[j] && event->getId() == id && event->isEnabled() &&
+          event->isRepeating() == repeating && event->interval == interval) {
+        // wraps around for small now values, but the trigger time sum is
+        // computed modulo 2^64 and comes out right
+        event->last_trigger_time = now + remaining - interval;
+        matched[j] = true;
+        restored++;
+        break;
+      }
+    }
+  }
+  timed_queue.rebuild();
+  xSemaphoreGiveRecursive(timed_queue_mutex_);
+  return restored;
+}
+
+DelayEvent* TimedEventBatch::onDelay(uint32_t delay,
+                                     react_callback callback) {
+  auto* dre = new DelayEvent(delay, callback);
+  add(dre);
+  return dre;
+}
+
+DelayEvent* TimedEventBatch::onDelayMicros(uint64_t delay,
+                                           react_callback callback) {
+  auto* dre = new DelayEvent(delay, callback);
+  add(dre);
+  return dre;
+}
+
+RepeatEvent* TimedEventBatch::onRepeat(uint32_t interval,
+                                       react_callback callback) {
+  auto* rre = new RepeatEvent(interval, callback);
+  add(rre);
+  return rre;
+}
+
+RepeatEvent* TimedEventBatch::onRepeatMicros(uint64_t interval,
+                                             react_callback callback) {
+  auto* rre = new RepeatEvent(interval, callback);
+  add(rre);
+  return rre;
+}
+
+void TimedEventBatch::commit() {
+  if (events.empty()) {
+    return;
+  }
+  xSemaphoreTakeRecursive(event_loop->timed_queue_mutex_, portMAX_DELAY);
+  event_loop->timed_queue.push_range(events.begin(), events.end());
+  xSemaphoreGiveRecursive(event_loop->timed_queue_mutex_);
+  events.clear();
+}
+
 }  // namespace reactesp
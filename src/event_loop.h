@@ -1,12 +1,119 @@
 #ifndef REACTESP_SRC_EVENT_LOOP_H_
 #define REACTESP_SRC_EVENT_LOOP_H_
 
+#include <algorithm>
+#include <iterator>
 #include <queue>
+#include <vector>
 
+#include "allocation_check.h"
 #include "events.h"
 
+#ifndef REACTESP_QUEUE_SET_LENGTH
+// Total length of the FreeRTOS queues and semaphores that can be waited on
+#define REACTESP_QUEUE_SET_LENGTH 32
+#endif
+
+#ifndef REACTESP_RTOS_POLL_MS
+// Maximum blocking time while FreeRTOS objects have to be polled
+#define REACTESP_RTOS_POLL_MS 10
+#endif
+
 namespace reactesp {
 
+template <typename T>
+class Channel;
+template <typename T>
+class ReceiveEvent;
+template <typename T>
+class SamplingEvent;
+
+/**
+ * @brief Load statistics of an event loop
+ *
+ * See EventLoop::enableOverloadDetection().
+ */
+struct LoadStats {
+  /// Share of the last window spent in ticks that dispatched events, in
+  /// percent
+  uint8_t utilization_percent = 0;
+  /// Average lateness of timed events in the last window, in microseconds
+  uint64_t average_lateness = 0;
+  bool overloaded = false;
+  /// Number of times the loop has entered the overloaded state
+  uint32_t overload_count = 0;
+  /// Number of sheddable event occurrences skipped
+  uint64_t shed_count = 0;
+};
+
+using overload_callback = std::function<void(const LoadStats& stats)>;
+
+/**
+ * @brief Reallocate a vector to hold max(size(), min_capacity) elements.
+ *
+ * The element order is preserved, so a heap stays a heap.
+ *
+ * @return Number of bytes released
+ */
+template <typename T>
+size_t shrink_vector(std::vector<T>& v, size_t min_capacity) {
+  const size_t old_capacity = v.capacity();
+  const size_t new_capacity = std::max(v.size(), min_capacity);
+  if (new_capacity >= old_capacity) {
+    return 0;
+  }
+  std::vector<T> shrunk;
+  shrunk.reserve(new_capacity);
+  shrunk.assign(v.begin(), v.end());
+  v.swap(shrunk);
+  return (old_capacity - v.capacity()) * sizeof(T);
+}
+
+/**
+ * @brief Priority queue of timed events that exposes the capacity of the
+ * underlying container.
+ */
+class TimedEventQueue
+    : public std::priority_queue<TimedEvent*, std::vector<TimedEvent*>,
+                                 TriggerTimeCompare> {
+ public:
+  void reserve(size_t n) { this->c.reserve(n); }
+  size_t capacity() const { return this->c.capacity(); }
+  /**
+   * @brief Release container capacity in excess of max(size(), min_capacity).
+   *
+   * @return Number of bytes released
+   */
+  size_t shrink(size_t min_capacity) {
+    return shrink_vector(this->c, min_capacity);
+  }
+  std::vector<TimedEvent*>& container() { return this->c; }
+  /**
+   * @brief Restore the heap order after trigger times have been modified
+   */
+  void rebuild() {
+    std::make_heap(this->c.begin(), this->c.end(), this->comp);
+  }
+  /**
+   * @brief Insert a range of events.
+   *
+   * Large ranges are appended and the heap is rebuilt in one O(n) pass;
+   * ranges small compared to the queue are pushed one by one.
+   */
+  template <typename InputIt>
+  void push_range(InputIt first, InputIt last) {
+    const size_t n = std::distance(first, last);
+    if (n < this->c.size()) {
+      for (; first != last; ++first) {
+        this->push(*first);
+      }
+      return;
+    }
+    this->c.insert(this->c.end(), first, last);
+    std::make_heap(this->c.begin(), this->c.end(), this->comp);
+  }
+};
+
 /**
  * @brief Asynchronous event loop supporting timed (repeating and
  * non-repeating), interrupt and stream events.
@@ -15,8 +122,12 @@ class EventLoop {
   friend class Event;
   friend class TimedEvent;
   friend class RepeatEvent;
+  friend class DescriptorTableEvent;
   friend class UntimedEvent;
   friend class ISREvent;
+  friend class TimedEventBatch;
+  friend class TriggeredEvent;
+  friend class RTOSEvent;
 
  public:
   /**
@@ -27,12 +138,14 @@ class EventLoop {
     timed_queue_mutex_ = xSemaphoreCreateRecursiveMutex();
     untimed_list_mutex_ = xSemaphoreCreateRecursiveMutex();
     isr_event_list_mutex_ = xSemaphoreCreateRecursiveMutex();
+    rtos_event_list_mutex_ = xSemaphoreCreateRecursiveMutex();
 
     // Initialize the mutexes
 
     xSemaphoreGiveRecursive(timed_queue_mutex_);
     xSemaphoreGiveRecursive(untimed_list_mutex_);
     xSemaphoreGiveRecursive(isr_event_list_mutex_);
+    xSemaphoreGiveRecursive(rtos_event_list_mutex_);
   }
 
   // Disabling copy constructors
@@ -42,21 +155,200 @@ class EventLoop {
   int getTimedEventQueueSize() { return timed_queue.size(); }
   int getUntimedEventQueueSize() { return untimed_list.size(); }
   int getISREventQueueSize() { return isr_event_list.size(); }
+  int getRTOSEventQueueSize() { return rtos_event_list.size(); }
   int getEventQueueSize() {
     return getTimedEventQueueSize() + getUntimedEventQueueSize() +
-           getISREventQueueSize();
+           getISREventQueueSize() + getRTOSEventQueueSize();
   }
 
   uint64_t getTimedEventCount() { return timed_event_counter; }
   uint64_t getUntimedEventCount() { return untimed_event_counter; }
+  uint64_t getTriggeredEventCount() { return triggered_event_counter; }
+  uint64_t getRTOSEventCount() { return rtos_event_counter; }
   uint64_t getEventCount() {
-    return getTimedEventCount() + getUntimedEventCount();
+    return getTimedEventCount() + getUntimedEventCount() +
+           getTriggeredEventCount() + getRTOSEventCount();
   }
 
   uint64_t getTickCount() { return tick_counter; }
 
+  /**
+   * @brief Return statistics on how late timed events were triggered
+   *
+   * The lateness is measured from the trigger time of each timed event
+   * dispatched by the loop to the time the loop got to it.
+   */
+  const LatenessStats& getLatenessStats() { return timed_lateness; }
+  void resetLatenessStats() { timed_lateness.reset(); }
+
+  /**
+   * @brief Detect overload from tick timing and shed sheddable events.
+   *
+   * The loop measures the share of time spent in ticks that dispatched
+   * timed, triggered or RTOS events, and the average lateness of timed
+   * events, over windows of window_ms milliseconds. Untimed events run on
+   * every tick and do not make a tick busy by themselves: their callback
+   * time is only counted in ticks that also dispatched another event. At
+   * the end of a window, the loop enters the overloaded state if the
+   * utilization is at or above high_percent or the average lateness
+   * exceeds max_lateness_us. It leaves the state once the utilization is
+   * below low_percent and the lateness is below half of max_lateness_us.
+   *
+   * While overloaded, repeating events marked with
+   * TimedEvent::setSheddable() only run once every setShedDivisor()
+   * occurrences; the other occurrences are skipped and counted.
+   *
+   * @param window_ms Measurement window. 0 disables the detection.
+   * @param high_percent Utilization threshold for entering overload
+   * @param low_percent Utilization threshold for leaving overload
+   * @param max_lateness_us Lateness threshold for entering overload. 0
+   *   disables the lateness criterion.
+   */
+  void enableOverloadDetection(uint32_t window_ms, uint8_t high_percent = 90,
+                               uint8_t low_percent = 70,
+                               uint32_t max_lateness_us = 0);
+
+  /**
+   * @brief Set how many occurrences of a sheddable event one is run while
+   *   overloaded.
+   *
+   * @param divisor 1 runs every occurrence, 2 every other occurrence, and so
+   *   on. 0 skips all occurrences. The default is 2.
+   */
+  void setShedDivisor(uint8_t divisor) { shed_divisor = divisor; }
+
+  /**
+   * @brief Register a callback called when the loop enters or leaves the
+   *   overloaded state
+   */
+  void onOverloadChange(overload_callback callback) {
+    overload_callbacks.push_back(callback);
+  }
+
+  bool isOverloaded() const { return load_stats.overloaded; }
+  const LoadStats& getLoadStats() const { return load_stats; }
+
+  /**
+   * @brief Reserve capacity for the event queues.
+   *
+   * Once the capacity has been reserved, adding and re-arming events
+   * up to the given counts does not reallocate the queue storage.
+   *
+   * @param timed_events Number of timed events to reserve space for
+   * @param untimed_events Number of untimed events to reserve space for
+   * @param isr_events Number of ISR events to reserve space for
+   */
+  void reserve(size_t timed_events, size_t untimed_events = 0,
+               size_t isr_events = 0);
+
+  /**
+   * @brief Assert that tick() performs no heap allocations.
+   *
+   * Call this at the end of setup(). From then on, any C++ heap allocation
+   * made by the task running tick() while the loop is executing triggers an
+   * assertion. Only effective when the library is built with
+   * REACTESP_ALLOCATION_CHECK defined; otherwise this is a no-op.
+   *
+   * @param enabled Whether the check is enabled
+   */
+  void enableAllocationCheck(bool enabled = true) {
+    allocation_check_enabled = enabled;
+  }
+
+  /**
+   * @brief Release excess queue capacity after sustained low occupancy.
+   *
+   * After a burst of events, the timed queue and the untimed list keep their
+   * peak capacity. With capacity reclaim enabled, a container whose
+   * occupancy stays at or below low_water_percent of its capacity for at
+   * least hold_ms milliseconds is reallocated to twice its current size,
+   * but never below the capacity requested with reserve(). The headroom
+   * keeps a container whose size hovers around the threshold from
+   * growing again on the next insertion.
+   *
+   * Reclaiming allocates memory and is therefore skipped while the
+   * allocation check is enabled.
+   *
+   * @param low_water_percent Occupancy threshold, in percent of capacity.
+   *   0 disables reclaiming.
+   * @param hold_ms Time the occupancy has to stay below the threshold
+   */
+  void setCapacityReclaim(uint8_t low_water_percent, uint32_t hold_ms);
+
+  /**
+   * @brief Return the total number of queue bytes released so far.
+   */
+  uint64_t getReclaimedBytes() { return reclaimed_bytes; }
+
+  /**
+   * @brief Serialize the timed event schedule.
+   *
+   * All enabled timed events with a non-zero id (see TimedEvent::setId())
+   * are written to the buffer along with their remaining time and interval,
+   * followed by the loop counters. The blob is compact and suitable for
+   * storing in RTC memory or flash before entering deep sleep.
+   *
+   * @param buffer Output buffer. If nullptr, only the required size is
+   *   computed.
+   * @param buffer_size Size of the output buffer, in bytes
+   * @return Number of bytes written (or required), or 0 if the buffer is
+   *   too small
+   */
+  size_t snapshotSchedule(uint8_t* buffer, size_t buffer_size);
+
+  /**
+   * @brief Restore the phase of timed events from a snapshot.
+   *
+   * Recreate the events with the same ids first, then call this function.
+   * Every event whose id and interval match a snapshot entry is
+   * rescheduled as if the loop had kept running for elapsed_us
+   * microseconds: repeating events resume in phase, and overdue delay
+   * events trigger on the next tick. Events without a matching entry are
+   * left untouched. Each entry restores at most one event, so events that
+   * share an id are matched to the entries with that id one to one. The
+   * loop counters are set to the values in the snapshot.
+   *
+   * @param buffer Snapshot created by snapshotSchedule()
+   * @param buffer_size Size of the snapshot, in bytes
+   * @param elapsed_us Time elapsed since the snapshot was taken, in
+   *   microseconds
+   * @return Number of restored events, or -1 if the snapshot is invalid
+   */
+  int restoreSchedule(const uint8_t* buffer, size_t buffer_size,
+                      uint64_t elapsed_us);
+
   void tick();
 
+  /**
+   * @brief Wait until there is work to do and then run one tick.
+   *
+   * Instead of spinning, the calling task blocks until the next timed event
+   * is due, a TriggeredEvent is triggered, a monitored FreeRTOS queue or
+   * semaphore is signalled, or max_wait_ms milliseconds have passed. Polled
+   * events (untimed events such as StreamEvent and TickEvent) need to be
+   * checked continuously; while any exist, the function does not block.
+   *
+   * @param max_wait_ms Maximum time to block, in milliseconds
+   */
+  void tickBlocking(uint32_t max_wait_ms = UINT32_MAX);
+
+  /**
+   * @brief Wake up the loop task if it is blocked in tickBlocking().
+   *
+   * Safe to call from other tasks and from interrupt handlers.
+   */
+  void ICACHE_RAM_ATTR wake();
+
+  /**
+   * @brief Return the current early wake margin for precise events
+   *
+   * The margin is calibrated automatically from the observed wake-up
+   * latency of tickBlocking(). See TimedEvent::setPrecise().
+   *
+   * @return Margin, in microseconds
+   */
+  uint32_t getEarlyWakeMargin() { return early_wake_margin; }
+
   /**
    * @brief Create a new DelayEvent
    *
@@ -89,6 +381,24 @@ class EventLoop {
    * @return RepeatEvent*
    */
   RepeatEvent* onRepeatMicros(uint64_t interval, react_callback callback);
+  /**
+   * @brief Create a new PreciseRepeatEvent
+   *
+   * @param interval Interval, in milliseconds
+   * @param callback Callback function, called from the esp_timer task
+   * @return PreciseRepeatEvent*
+   */
+  PreciseRepeatEvent* onPreciseRepeat(uint32_t interval,
+                                      react_callback callback);
+  /**
+   * @brief Create a new PreciseRepeatEvent
+   *
+   * @param interval Interval, in microseconds
+   * @param callback Callback function, called from the esp_timer task
+   * @return PreciseRepeatEvent*
+   */
+  PreciseRepeatEvent* onPreciseRepeatMicros(uint64_t interval,
+                                            react_callback callback);
   /**
    * @brief Create a new StreamEvent
    *
@@ -97,6 +407,26 @@ class EventLoop {
    * @return StreamEvent*
    */
   StreamEvent* onAvailable(Stream& stream, react_callback callback);
+  /**
+   * @brief Create a new StreamMuxEvent
+   *
+   * Streams are added to the returned event with
+   * StreamMuxEvent::addStream().
+   *
+   * @param max_backoff Maximum polling interval of idle streams, in ticks
+   * @return StreamMuxEvent*
+   */
+  StreamMuxEvent* onAvailableMux(uint16_t max_backoff = 16);
+  /**
+   * @brief Create a new WritableEvent
+   *
+   * @param stream Arduino Stream object to monitor
+   * @param min_space Minimum free space in the write buffer, in bytes
+   * @param callback Callback function
+   * @return WritableEvent*
+   */
+  WritableEvent* onWritable(Stream& stream, int min_space,
+                            react_callback callback);
   /**
    * @brief Create a new ISREvent (interrupt event)
    *
@@ -108,6 +438,64 @@ class EventLoop {
    * @return ISREvent*
    */
   ISREvent* onInterrupt(uint8_t pin_number, int mode, react_callback callback);
+  /**
+   * @brief Create a new BarrierEvent
+   *
+   * @param count Number of arrivals to wait for
+   * @param callback Function called with timed_out set to false once all
+   *   arrivals have been signalled, or to true if the timeout expired first
+   * @param timeout Timeout in milliseconds. 0 disables the timeout.
+   * @return BarrierEvent*
+   */
+  BarrierEvent* onBarrier(uint32_t count, barrier_callback callback,
+                          uint32_t timeout = 0);
+  /**
+   * @brief Create a new DescriptorTableEvent
+   *
+   * @param table Table of event descriptors, usually const PROGMEM
+   * @param count Number of entries in the table
+   * @return DescriptorTableEvent*
+   */
+  DescriptorTableEvent* onDescriptorTable(const EventDescriptor* table,
+                                          size_t count);
+  template <size_t N>
+  DescriptorTableEvent* onDescriptorTable(const EventDescriptor (&table)[N]) {
+    return onDescriptorTable(table, N);
+  }
+  /**
+   * @brief Create a new PulseEvent
+   *
+   * @param pin_number GPIO pin of the measured signal
+   * @param window_ms Length of the measurement window
+   * @param callback Function called with the statistics of each window
+   * @param measure_width Measure pulse width and duty cycle in addition to
+   *   frequency
+   * @return PulseEvent*
+   */
+  PulseEvent* onPulse(uint8_t pin_number, uint32_t window_ms,
+                      pulse_callback callback, bool measure_width = true);
+  /**
+   * @brief Create a new EncoderEvent
+   *
+   * @param pin_a GPIO pin of encoder channel A
+   * @param pin_b GPIO pin of encoder channel B
+   * @param callback Function called with the position and the change since
+   *   the previous call
+   * @param notify_interval_us If 0, notify on every position change.
+   *   Otherwise, check the position at this interval.
+   * @return EncoderEvent*
+   */
+  EncoderEvent* onEncoder(uint8_t pin_a, uint8_t pin_b,
+                          encoder_callback callback,
+                          uint32_t notify_interval_us = 0);
+  /**
+   * @brief Create a new PinGroupEvent
+   *
+   * Pins are added to the returned event with PinGroupEvent::addPin().
+   *
+   * @return PinGroupEvent*
+   */
+  PinGroupEvent* onPinGroup();
   /**
    * @brief Create a new TickEvent
    *
@@ -115,10 +503,88 @@ class EventLoop {
    * @return TickEvent*
    */
   TickEvent* onTick(react_callback callback);
+  /**
+   * @brief Create a new TriggeredEvent
+   *
+   * @param callback Callback function to be called after each call to
+   *   TriggeredEvent::trigger()
+   * @return TriggeredEvent*
+   */
+  TriggeredEvent* onTrigger(react_callback callback);
+  /**
+   * @brief Create a new QueueEvent
+   *
+   * @param queue FreeRTOS queue to monitor
+   * @param callback Callback function to be called once for each item sent
+   *   to the queue. It should receive exactly one item.
+   * @return QueueEvent*
+   */
+  QueueEvent* onQueue(QueueHandle_t queue, react_callback callback);
+  /**
+   * @brief Create a new SemaphoreEvent
+   *
+   * @param semaphore FreeRTOS semaphore to monitor
+   * @param callback Callback function to be called for each give
+   * @return SemaphoreEvent*
+   */
+  SemaphoreEvent* onSemaphore(SemaphoreHandle_t semaphore,
+                              react_callback callback);
+  /**
+   * @brief Create a new EventBitsEvent
+   *
+   * @param event_group FreeRTOS event group to monitor
+   * @param bits Bits to monitor
+   * @param callback Callback function to be called with the set bits
+   * @param clear_on_trigger Clear the bits before calling the callback
+   * @return EventBitsEvent*
+   */
+  EventBitsEvent* onEventBits(EventGroupHandle_t event_group, EventBits_t bits,
+                              event_bits_callback callback,
+                              bool clear_on_trigger = true);
+  /**
+   * @brief Create a new ReceiveEvent (defined in channel.h)
+   *
+   * @param channel Channel to receive items from
+   * @param callback Callback receiving batches of items
+   * @param max_batch Maximum number of items per callback call
+   * @return ReceiveEvent<T>*
+   */
+  template <typename T>
+  ReceiveEvent<T>* onReceive(
+      Channel<T>& channel,
+      std::function<void(const T* items, size_t count)> callback,
+      size_t max_batch = 16);
+  /**
+   * @brief Create a new SamplingEvent (defined in sampling.h)
+   *
+   * @param interval_us Sampling interval, in microseconds
+   * @param sampler Function returning one sample
+   * @param batch_size Number of samples per callback call
+   * @param callback Callback receiving batches of samples
+   * @param decimation Number of raw samples per stored sample
+   * @param average Store the average of the raw samples instead of the
+   *   first one
+   * @return SamplingEvent<T>*
+   */
+  template <typename T>
+  SamplingEvent<T>* onSamplingMicros(
+      uint64_t interval_us, std::function<T()> sampler, size_t batch_size,
+      std::function<void(const T* samples, size_t count)> callback,
+      uint32_t decimation = 1, bool average = false);
+  /**
+   * @brief Run a compile-time schedule (defined in static_schedule.h)
+   *
+   * @tparam Schedule StaticSchedule type, see REACTESP_STATIC_SCHEDULE()
+   * @return RepeatEvent* The base timer of the schedule. Remove it to stop
+   *   the schedule.
+   */
+  template <typename Schedule>
+  RepeatEvent* onStaticSchedule();
 
   void remove(TimedEvent* event);
   void remove(UntimedEvent* event);
   void remove(ISREvent* event);
+  void remove(RTOSEvent* event);
 
   /**
    * @brief Remove an event from the list of active events
@@ -131,8 +597,7 @@ class EventLoop {
   // Timed events are stored in a priority queue, sorted by trigger time. It
   // pretty much always suffices to just access the top element of the queue.
   // Element removal is always done by invalidating the element.
-  std::priority_queue<TimedEvent*, std::vector<TimedEvent*>, TriggerTimeCompare>
-      timed_queue;
+  TimedEventQueue timed_queue;
   // Untimed events are stored in a vector, which is traversed in order.
   // Elements are rarely removed from the middle of the list, so a vector is
   // acceptable.
@@ -140,18 +605,147 @@ class EventLoop {
   // ISR events are stored in a vector. The list is traversed or modified
   // infrequently.
   std::vector<ISREvent*> isr_event_list;
+  // FreeRTOS object events are stored in a vector and checked on every
+  // tick.
+  std::vector<RTOSEvent*> rtos_event_list;
 
   // Semaphores for accessing the above queues and lists
   SemaphoreHandle_t timed_queue_mutex_;
   SemaphoreHandle_t untimed_list_mutex_;
   SemaphoreHandle_t isr_event_list_mutex_;
+  SemaphoreHandle_t rtos_event_list_mutex_;
+
+  // Queue set for blocking until an event source is signalled. Created on
+  // first use.
+  QueueSetHandle_t queue_set = nullptr;
+  // Binary semaphore in the queue set, given to wake up a blocked loop
+  SemaphoreHandle_t wakeup_semaphore = nullptr;
+  size_t queue_set_free = 0;
+  // Number of RTOS events that are not in the queue set and have to be
+  // polled
+  size_t polled_rtos_events = 0;
+  // Set while the loop task is blocked in tickBlocking()
+  std::atomic<bool> waiting{false};
+
+  // Early wake calibration for precise events: the margin and smoothed
+  // mean and mean deviation of the wake-up latency, in microseconds
+  uint32_t early_wake_margin = 1000 * portTICK_PERIOD_MS;
+  int32_t wake_latency_mean = 0;
+  int32_t wake_latency_deviation = 500 * portTICK_PERIOD_MS;
+
+  void updateWakeLatency(int32_t latency);
 
   uint64_t timed_event_counter = 0;
   uint64_t untimed_event_counter = 0;
+  uint64_t triggered_event_counter = 0;
+  uint64_t rtos_event_counter = 0;
   uint64_t tick_counter = 0;
+  LatenessStats timed_lateness;
+
+  // Triggered events waiting to be run, as a lock-free intrusive stack
+  // that can be pushed to from interrupt handlers and other tasks
+  std::atomic<TriggeredEvent*> pending_head{nullptr};
+
+  bool allocation_check_enabled = false;
+
+  // Capacity reclaim state
+  size_t reserved_timed_events = 0;
+  size_t reserved_untimed_events = 0;
+  uint8_t reclaim_low_water_percent = 0;
+  uint64_t reclaim_hold_time = 0;
+  bool timed_low_occupancy = false;
+  bool untimed_low_occupancy = false;
+  uint64_t timed_low_occupancy_since = 0;
+  uint64_t untimed_low_occupancy_since = 0;
+  uint64_t reclaimed_bytes = 0;
+
+  void reclaimCapacity();
+
+  // Overload detection state
+  uint64_t overload_window = 0;
+  uint8_t overload_high_percent = 0;
+  uint8_t overload_low_percent = 0;
+  uint32_t overload_max_lateness = 0;
+  uint8_t shed_divisor = 2;
+  uint64_t load_window_start = 0;
+  uint64_t load_window_busy = 0;
+  LatenessStats load_window_lateness;
+  LoadStats load_stats;
+  std::vector<overload_callback> overload_callbacks;
 
+  void updateLoad(uint64_t tick_start, uint64_t dispatched_before);
+  bool shed(TimedEvent* event);
+
+  // run one tick; with timed_first, due timed events are dispatched before
+  // the other phases
+  void runTick(bool timed_first);
   void tickTimed();
   void tickUntimed();
+  void tickTriggered();
+  void tickRTOS();
+
+  void ICACHE_RAM_ATTR pushPending(TriggeredEvent* event);
+  void createQueueSet();
+  // account for one queue set entry of the member
+  void handleSetMember(QueueSetMemberHandle_t member);
+  void addRTOSEvent(RTOSEvent* event);
+};
+
+/**
+ * @brief Builder for adding a large number of timed events at once.
+ *
+ * Events created through the batch are collected locally and inserted
+ * into the event loop with a single lock acquisition and heap rebuild
+ * when commit() is called or the batch goes out of scope.
+ *
+ * @code
+ * TimedEventBatch batch(&event_loop, 200);
+ * for (int i = 0; i < 200; i++) {
+ *   batch.onRepeat(100 + i, [i]() { ... });
+ * }
+ * batch.commit();
+ * @endcode
+ */
+class TimedEventBatch {
+ public:
+  /**
+   * @brief Construct a new TimedEventBatch object
+   *
+   * @param event_loop Event loop the events are added to
+   * @param expected_size Number of events to reserve space for
+   */
+  TimedEventBatch(EventLoop* event_loop, size_t expected_size = 0)
+      : event_loop(event_loop) {
+    events.reserve(expected_size);
+  }
+  ~TimedEventBatch() { commit(); }
+
+  TimedEventBatch(const TimedEventBatch&) = delete;
+  TimedEventBatch& operator=(const TimedEventBatch&) = delete;
+
+  DelayEvent* onDelay(uint32_t delay, react_callback callback);
+  DelayEvent* onDelayMicros(uint64_t delay, react_callback callback);
+  RepeatEvent* onRepeat(uint32_t interval, react_callback callback);
+  RepeatEvent* onRepeatMicros(uint64_t interval, react_callback callback);
+
+  /**
+   * @brief Add an existing timed event to the batch
+   */
+  void add(TimedEvent* event) { events.push_back(event); }
+
+  /**
+   * @brief Return the number of uncommitted events
+   */
+  size_t size() const { return events.size(); }
+
+  /**
+   * @brief Insert all uncommitted events into the event loop
+   */
+  void commit();
+
+ private:
+  EventLoop* event_loop;
+  std::vector<TimedEvent*> events;
 };
 
 // Provide compatibility aliases for the old naming scheme
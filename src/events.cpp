@@ -1,6 +1,9 @@
 #include "events.h"
 
 #include <freertos/semphr.h>
+#ifdef ESP32
+#include <soc/gpio_struct.h>
+#endif
 
 #include "event_loop.h"
 
@@ -55,6 +58,164 @@ void RepeatEvent::tick(EventLoop* event_loop) {
   xSemaphoreGiveRecursive(event_loop->timed_queue_mutex_);
 }
 
+PreciseRepeatEvent::PreciseRepeatEvent(uint32_t interval,
+                                       react_callback callback)
+    : RepeatEvent(interval, callback) {
+#ifdef ESP32
+  mutex_ = xSemaphoreCreateRecursiveMutex();
+#endif
+}
+
+PreciseRepeatEvent::PreciseRepeatEvent(uint64_t interval,
+                                       react_callback callback)
+    : RepeatEvent(interval, callback) {
+#ifdef ESP32
+  mutex_ = xSemaphoreCreateRecursiveMutex();
+#endif
+}
+
+#ifdef ESP32
+PreciseRepeatEvent::~PreciseRepeatEvent() { vSemaphoreDelete(mutex_); }
+
+void PreciseRepeatEvent::dispatch(void* this_ptr) {
+  auto* this_ = static_cast<PreciseRepeatEvent*>(this_ptr);
+  xSemaphoreTakeRecursive(this_->mutex_, portMAX_DELAY);
+  if (this_->enabled) {
+    const uint64_t now = micros64();
+    this_->lateness.record(now > this_->due_time ? now - this_->due_time : 0);
+    this_->last_trigger_time = now;
+    this_->due_time += this_->interval;
+    if (this_->due_time + this_->interval < now) {
+      // callbacks were skipped; resynchronize
+      this_->due_time = now + this_->interval;
+    }
+    this_->callback();
+  }
+  xSemaphoreGiveRecursive(this_->mutex_);
+}
+
+void PreciseRepeatEvent::add(EventLoop* event_loop) {
+  esp_timer_create_args_t args = {};
+  args.callback = &PreciseRepeatEvent::dispatch;
+  args.arg = this;
+  args.dispatch_method = ESP_TIMER_TASK;
+  args.name = "reactesp";
+  esp_timer_create(&args, &timer);
+  last_trigger_time = micros64();
+  due_time = last_trigger_time + interval;
+  esp_timer_start_periodic(timer, interval);
+}
+
+void PreciseRepeatEvent::release(void* this_ptr) {
+  auto* this_ = static_cast<PreciseRepeatEvent*>(this_ptr);
+  esp_timer_delete(this_->release_timer);
+  delete this_;
+}
+
+void PreciseRepeatEvent::remove(EventLoop* event_loop) {
+  esp_timer_stop(timer);
+  esp_timer_delete(timer);
+  timer = nullptr;
+  // wait for a dispatch() running in the esp_timer task
+  xSemaphoreTakeRecursive(mutex_, portMAX_DELAY);
+  enabled = false;
+  xSemaphoreGiveRecursive(mutex_);
+  // A dispatch() may still be about to take the mutex, or may be the
+  // caller. esp_timer callbacks run one at a time in the esp_timer task,
+  // so free the object from a callback queued after it.
+  esp_timer_create_args_t args = {};
+  args.callback = &PreciseRepeatEvent::release;
+  args.arg = this;
+  args.dispatch_method = ESP_TIMER_TASK;
+  args.name = "reactesp";
+  esp_timer_create(&args, &release_timer);
+  esp_timer_start_once(release_timer, 0);
+}
+
+LatenessStats PreciseRepeatEvent::getLatenessStats() {
+  xSemaphoreTakeRecursive(mutex_, portMAX_DELAY);
+  LatenessStats stats = lateness;
+  xSemaphoreGiveRecursive(mutex_);
+  return stats;
+}
+#else
+void PreciseRepeatEvent::tick(EventLoop* event_loop) {
+  const uint64_t now = micros64();
+  const uint64_t due_time = getTriggerTimeMicros();
+  lateness.record(now > due_time ? now - due_time : 0);
+  RepeatEvent::tick(event_loop);
+}
+
+LatenessStats PreciseRepeatEvent::getLatenessStats() { return lateness; }
+#endif
+
+DescriptorTableEvent::DescriptorTableEvent(const EventDescriptor* table,
+                                           size_t count)
+    : TimedEvent((uint64_t)0, nullptr),
+      table(table),
+      count(count),
+      deadlines(new uint32_t[count]) {}
+
+void DescriptorTableEvent::schedule(uint64_t now) {
+  // The table is triggered at the earliest deadline. The deadlines wrap
+  // around after 49.7 days; only the remaining times are taken from them.
+  const uint64_t now_ms = now / 1000;
+  uint32_t next = UINT32_MAX;
+  for (size_t i = 0; i < count; i++) {
+    const int32_t remaining = (int32_t)(deadlines[i] - (uint32_t)now_ms);
+    const uint32_t wait = remaining > 0 ? remaining : 0;
+    if (wait < next) {
+      next = wait;
+    }
+  }
+  last_trigger_time = 1000 * (now_ms + next);
+}
+
+void DescriptorTableEvent::add(EventLoop* event_loop) {
+  const uint64_t now = micros64();
+  const uint32_t now_ms = now / 1000;
+  for (size_t i = 0; i < count; i++) {
+    EventDescriptor descriptor;
+    memcpy_P(&descriptor, &table[i], sizeof(descriptor));
+    deadlines[i] = (descriptor.flags & REACTESP_DESCRIPTOR_RUN_AT_START)
+                       ? now_ms
+                       : now_ms + descriptor.interval;
+  }
+  schedule(now);
+  TimedEvent::add(event_loop);
+}
+
+void DescriptorTableEvent::tick(EventLoop* event_loop) {
+  xSemaphoreTakeRecursive(event_loop->timed_queue_mutex_, portMAX_DELAY);
+  const uint32_t now_ms = micros64() / 1000;
+  for (size_t i = 0; i < count; i++) {
+    if ((int32_t)(deadlines[i] - now_ms) > 0) {
+      continue;
+    }
+    EventDescriptor descriptor;
+    memcpy_P(&descriptor, &table[i], sizeof(descriptor));
+    deadlines[i] += descriptor.interval;
+    if ((int32_t)(deadlines[i] - now_ms) <= 0) {
+      // we're lagging more than one full interval; reset the time
+      deadlines[i] = now_ms + descriptor.interval;
+    }
+    descriptor.function();
+  }
+  schedule(micros64());
+  event_loop->timed_queue.push(this);
+  xSemaphoreGiveRecursive(event_loop->timed_queue_mutex_);
+}
+
+int DescriptorTableEvent::find(const char* name) const {
+  for (size_t i = 0; i < count; i++) {
+    const char* entry_name = (const char*)pgm_read_ptr(&table[i].name);
+    if (entry_name != nullptr && strcmp_P(name, entry_name) == 0) {
+      return i;
+    }
+  }
+  return -1;
+}
+
 void UntimedEvent::add(EventLoop* event_loop) {
   xSemaphoreTakeRecursive(event_loop->untimed_list_mutex_, portMAX_DELAY);
   event_loop->untimed_list.push_back(this);
@@ -65,36 +226,820 @@ void UntimedEvent::remove(EventLoop* event_loop) {
   event_loop->remove(this);
 }
 
-void StreamEvent::tick(EventLoop* event_loop) {
+void UntimedEvent::unlink(EventLoop* event_loop) {
+  xSemaphoreTakeRecursive(event_loop->untimed_list_mutex_, portMAX_DELAY);
+  auto it = std::find(event_loop->untimed_list.begin(),
+                      event_loop->untimed_list.end(), this);
+  if (it != event_loop->untimed_list.end()) {
+    event_loop->untimed_list.erase(it);
+  }
+  xSemaphoreGiveRecursive(event_loop->untimed_list_mutex_);
+}
+
+void StreamEvent::add(EventLoop* event_loop) {
+  this->event_loop = event_loop;
+  if (notify_driven) {
+    notifier = event_loop->onTrigger([this]() { this->check(); });
+    // check once in case input arrived before the hook was installed
+    notifier->trigger();
+  } else {
+    UntimedEvent::add(event_loop);
+  }
+}
+
+void StreamEvent::remove(EventLoop* event_loop) {
+  if (notifier != nullptr) {
+    notifier->remove(event_loop);
+    notifier = nullptr;
+  }
+  UntimedEvent::remove(event_loop);
+}
+
+void StreamEvent::tick(EventLoop* event_loop) { check(); }
+
+void StreamEvent::check() {
   if (0 != stream.available()) {
     this->callback();
+    if (notifier != nullptr && 0 != stream.available()) {
+      // the callback left input unread; check again on the next tick
+      notifier->trigger();
+    }
+  }
+}
+
+void StreamEvent::setNotifyDriven(bool notify_driven) {
+  if (notify_driven == this->notify_driven) {
+    return;
+  }
+  if (event_loop == nullptr) {
+    this->notify_driven = notify_driven;
+    return;
+  }
+  // move the event between the untimed list and the notifier
+  if (notify_driven) {
+    unlink(event_loop);
+  } else {
+    notifier->remove(event_loop);
+    notifier = nullptr;
+  }
+  this->notify_driven = notify_driven;
+  add(event_loop);
+}
+
+void ICACHE_RAM_ATTR StreamEvent::notify() {
+  TriggeredEvent* notifier = this->notifier;
+  if (notifier != nullptr) {
+    notifier->trigger();
+  }
+}
+
+void StreamMuxEvent::addStream(Stream& stream, react_callback callback) {
+  // entries must not move while one of their callbacks is running
+  (ticking ? added : entries).push_back({&stream, callback, 1, 0, true, false});
+}
+
+bool StreamMuxEvent::poll(Entry& entry) {
+  poll_count++;
+  if (0 != entry.stream->available()) {
+    entry.active = true;
+    entry.interval = 1;
+    entry.countdown = 0;
+    entry.callback();
+    return true;
+  }
+  entry.active = false;
+  if (entry.interval < max_backoff) {
+    entry.interval = std::min<uint16_t>(2 * entry.interval, max_backoff);
+  }
+  entry.countdown = entry.interval - 1;
+  return false;
+}
+
+void StreamMuxEvent::tick(EventLoop* event_loop) {
+  ticking = true;
+  // the entries stay in place until the end of the tick
+  Entry* const table = entries.data();
+  const size_t count = entries.size();
+  // serve the streams that had input on the previous pass first
+  for (size_t i = 0; i < count; i++) {
+    Entry& entry = table[i];
+    entry.served = entry.active;
+    if (entry.active) {
+      poll(entry);
+    }
+  }
+  for (size_t i = 0; i < count; i++) {
+    Entry& entry = table[i];
+    if (entry.served) {
+      continue;
+    }
+    if (entry.countdown > 0) {
+      entry.countdown--;
+      continue;
+    }
+    poll(entry);
+  }
+  ticking = false;
+  if (!added.empty()) {
+    for (Entry& entry : added) {
+      entries.push_back(std::move(entry));
+    }
+    added.clear();
+  }
+}
+
+void WritableEvent::add(EventLoop* event_loop) {
+  this->event_loop = event_loop;
+  if (enabled) {
+    UntimedEvent::add(event_loop);
+  }
+}
+
+void WritableEvent::tick(EventLoop* event_loop) {
+  if (stream.availableForWrite() >= min_space) {
+    this->callback();
+  }
+}
+
+void WritableEvent::enable() {
+  if (enabled) {
+    return;
+  }
+  enabled = true;
+  if (event_loop != nullptr) {
+    UntimedEvent::add(event_loop);
+  }
+}
+
+void WritableEvent::disable() {
+  if (!enabled) {
+    return;
+  }
+  enabled = false;
+  if (event_loop != nullptr) {
+    unlink(event_loop);
   }
 }
 
 void TickEvent::tick(EventLoop* event_loop) { this->callback(); }
 
+void TriggeredEvent::add(EventLoop* event_loop) {
+  this->event_loop = event_loop;
+}
+
+void TriggeredEvent::remove(EventLoop* event_loop) {
+  this->enabled = false;
+  if (this->event_loop == nullptr) {
+    delete this;
+    return;
+  }
+  // the object will be deleted when the event loop pops it out of the
+  // pending list
+  trigger();
+}
+
+void TriggeredEvent::tick(EventLoop* event_loop) { this->callback(); }
+
+void ICACHE_RAM_ATTR TriggeredEvent::trigger() {
+  if (event_loop == nullptr || pending.exchange(true)) {
+    return;
+  }
+  event_loop->pushPending(this);
+  event_loop->wake();
+}
+
+void RTOSEvent::add(EventLoop* event_loop) { event_loop->addRTOSEvent(this); }
+
+void RTOSEvent::remove(EventLoop* event_loop) { event_loop->remove(this); }
+
+bool QueueEvent::poll() {
+  // In the queue set, each entry stands for one item sent; a polled queue
+  // is checked for the items waiting.
+  const uint32_t items =
+      queue_set_slots != 0 ? signalled : uxQueueMessagesWaiting(queue);
+  signalled = 0;
+  for (uint32_t i = 0; i < items; i++) {
+    this->callback();
+  }
+  return items != 0;
+}
+
+bool SemaphoreEvent::poll() {
+  // take the semaphore once per queue set entry, or while it is available
+  uint32_t gives = queue_set_slots != 0 ? signalled : UINT32_MAX;
+  signalled = 0;
+  bool triggered = false;
+  while (gives > 0 && xSemaphoreTake(semaphore, 0) == pdTRUE) {
+    gives--;
+    this->callback();
+    triggered = true;
+  }
+  return triggered;
+}
+
+bool EventBitsEvent::poll() {
+  const EventBits_t set_bits = xEventGroupGetBits(event_group) & bits;
+  if (set_bits == 0) {
+    return false;
+  }
+  if (clear_on_trigger) {
+    xEventGroupClearBits(event_group, set_bits);
+  }
+  bits_callback(set_bits);
+  return true;
+}
+
 #ifdef ESP32
 bool ISREvent::isr_service_installed = false;
+#endif
+
+void ISREvent::configurePin(uint8_t pin_number, int mode) {
+  setInterruptType(pin_number, mode);
+#ifdef ESP32
+  installIsrService();
+#endif
+}
+
+void ISREvent::setInterruptType(uint8_t pin_number, int mode) {
+#ifdef ESP32
+  gpio_int_type_t intr_type;
+  switch (mode) {
+    case RISING:
+      intr_type = GPIO_INTR_POSEDGE;
+      break;
+    case FALLING:
+      intr_type = GPIO_INTR_NEGEDGE;
+      break;
+    case CHANGE:
+      intr_type = GPIO_INTR_ANYEDGE;
+      break;
+    default:
+      intr_type = GPIO_INTR_DISABLE;
+      break;
+  }
+  // configure the IO pin
+  gpio_set_intr_type((gpio_num_t)pin_number, intr_type);
+#endif
+}
+
+#ifdef ESP32
+void ISREvent::installIsrService() {
+  // While the shared pin group handler owns the GPIO interrupt, the service
+  // cannot be installed and the pins are served by that handler instead.
+  if (isr_service_installed || PinGroupEvent::ownsGpioInterrupt()) {
+    return;
+  }
+  const esp_err_t err = gpio_install_isr_service(ESP_INTR_FLAG_LOWMED);
+  // ESP_ERR_INVALID_STATE if installed elsewhere, e.g. by attachInterrupt()
+  isr_service_installed = err == ESP_OK || err == ESP_ERR_INVALID_STATE;
+}
 
-void ISREvent::isr(void* this_ptr) {
+esp_err_t ISREvent::addPinHandler(uint8_t pin_number, gpio_isr_t handler,
+                                  void* arg) {
+  // the shared handler may have been freed since the pin was configured
+  installIsrService();
+  if (isr_service_installed) {
+    return gpio_isr_handler_add((gpio_num_t)pin_number, handler, arg);
+  }
+  return PinGroupEvent::routePinHandler(pin_number, handler, arg);
+}
+
+void ISREvent::removePinHandler(uint8_t pin_number) {
+  if (isr_service_installed) {
+    gpio_isr_handler_remove((gpio_num_t)pin_number);
+  } else {
+    PinGroupEvent::unroutePinHandler(pin_number);
+  }
+}
+#endif
+
+void ICACHE_RAM_ATTR ISREvent::isr(void* this_ptr) {
   auto* this_ = static_cast<ISREvent*>(this_ptr);
-  this_->callback();
+  this_->interrupt();
 }
+
+void ISREvent::attach() {
+#ifdef ESP32
+  addPinHandler(pin_number, ISREvent::isr, (void*)this);
+#elif defined(ESP8266)
+  attachInterruptArg(digitalPinToInterrupt(pin_number), ISREvent::isr,
+                     (void*)this, mode);
 #endif
+}
 
-void ISREvent::add(EventLoop* event_loop) {
-  xSemaphoreTakeRecursive(event_loop->isr_event_list_mutex_, portMAX_DELAY);
+void ISREvent::detach() {
 #ifdef ESP32
-  gpio_isr_handler_add((gpio_num_t)pin_number, ISREvent::isr, (void*)this);
+  removePinHandler(pin_number);
 #elif defined(ESP8266)
-  attachInterrupt(digitalPinToInterrupt(pin_number), callback, mode);
+  detachInterrupt(digitalPinToInterrupt(pin_number));
 #endif
+}
+
+void ISREvent::add(EventLoop* event_loop) {
+  xSemaphoreTakeRecursive(event_loop->isr_event_list_mutex_, portMAX_DELAY);
+  attach();
+  if (!enabled) {
+    enabled = true;
+    disable();
+  }
   event_loop->isr_event_list.push_back(this);
   xSemaphoreGiveRecursive(event_loop->isr_event_list_mutex_);
 }
 
+void ISREvent::enable() {
+  if (enabled) {
+    return;
+  }
+  enabled = true;
+#ifdef ESP32
+  gpio_intr_enable((gpio_num_t)pin_number);
+#elif defined(ESP8266)
+  attachInterruptArg(digitalPinToInterrupt(pin_number), ISREvent::isr,
+                     (void*)this, mode);
+#endif
+}
+
+void ISREvent::disable() {
+  if (!enabled) {
+    return;
+  }
+  enabled = false;
+#ifdef ESP32
+  gpio_intr_disable((gpio_num_t)pin_number);
+#elif defined(ESP8266)
+  detachInterrupt(digitalPinToInterrupt(pin_number));
+#endif
+}
+
 void ISREvent::remove(EventLoop* event_loop) {
+  // Detach before deleting: by the time ~ISREvent runs, the members of a
+  // derived event have been destroyed and an interrupt would call the
+  // base class handler.
+  detach();
   event_loop->remove(this);
 }
 
+void ICACHE_RAM_ATTR PulseEvent::interrupt() {
+  const uint64_t now = micros64();
+  edge(mode == RISING || digitalRead(pin_number), now);
+}
+
+void ICACHE_RAM_ATTR PulseEvent::edge(bool level, uint64_t timestamp) {
+  lock.enter();
+  if (level) {
+    if (last_rising != 0) {
+      const uint64_t period = timestamp - last_rising;
+      const uint32_t period32 =
+          period > UINT32_MAX ? UINT32_MAX : (uint32_t)period;
+      period_count++;
+      period_sum += period;
+      if (period32 < min_period) {
+        min_period = period32;
+      }
+      if (period32 > max_period) {
+        max_period = period32;
+      }
+    }
+    last_rising = timestamp;
+  } else if (last_rising != 0) {
+    width_count++;
+    width_sum += timestamp - last_rising;
+  }
+  lock.exit();
+}
+
+void PulseEvent::report() {
+  lock.enter();
+  const uint32_t n_periods = period_count;
+  const uint64_t sum_periods = period_sum;
+  const uint32_t min_p = min_period;
+  const uint32_t max_p = max_period;
+  const uint32_t n_widths = width_count;
+  const uint64_t sum_widths = width_sum;
+  period_count = 0;
+  period_sum = 0;
+  min_period = UINT32_MAX;
+  max_period = 0;
+  width_count = 0;
+  width_sum = 0;
+  lock.exit();
+
+  PulseStats stats;
+  stats.period_count = n_periods;
+  if (n_periods > 0) {
+    stats.average_period_us = (float)sum_periods / n_periods;
+    stats.frequency = 1e6f / stats.average_period_us;
+    stats.min_period_us = min_p;
+    stats.max_period_us = max_p;
+  }
+  if (n_widths > 0) {
+    stats.average_width_us = (float)sum_widths / n_widths;
+    if (n_periods > 0) {
+      stats.duty_cycle = stats.average_width_us / stats.average_period_us;
+    }
+  }
+  pulse_cb(stats);
+}
+
+void PulseEvent::add(EventLoop* event_loop) {
+  ISREvent::add(event_loop);
+  window_timer =
+      event_loop->onRepeat(window_ms, [this]() { this->report(); });
+}
+
+void PulseEvent::remove(EventLoop* event_loop) {
+  if (window_timer != nullptr) {
+    window_timer->remove(event_loop);
+    window_timer = nullptr;
+  }
+  ISREvent::remove(event_loop);
+}
+
+void BarrierEvent::TimeoutEvent::start(EventLoop* event_loop) {
+  const uint64_t now = micros64();
+  deadline = now + interval;
+  if (!queued) {
+    last_trigger_time = now;
+    queued = true;
+    TimedEvent::add(event_loop);
+  }
+  // otherwise tick() pushes the queued timer back to the new deadline
+}
+
+void BarrierEvent::TimeoutEvent::tick(EventLoop* event_loop) {
+  queued = false;
+  if (deadline == 0) {
+    // cancelled; wait in the idle state for the next start()
+    return;
+  }
+  if (micros64() < deadline) {
+    // restarted since it was queued
+    last_trigger_time = deadline - interval;
+    queued = true;
+    TimedEvent::add(event_loop);
+    return;
+  }
+  deadline = 0;
+  barrier->expire();
+}
+
+void BarrierEvent::TimeoutEvent::remove(EventLoop* event_loop) {
+  if (queued) {
+    // deleted by the event loop when it is popped out of the timer queue
+    TimedEvent::remove(event_loop);
+  } else {
+    delete this;
+  }
+}
+
+void BarrierEvent::startTimeout() {
+  if (timeout_event != nullptr) {
+    timeout_event->start(event_loop);
+  }
+}
+
+void BarrierEvent::cancelTimeout() {
+  if (timeout_event != nullptr) {
+    timeout_event->cancel();
+  }
+}
+
+void BarrierEvent::expire() {
+  // whoever brings the counter to zero fires the event
+  if (remaining.exchange(0) > 0) {
+    timed_out = true;
+    trigger();
+  }
+}
+
+void BarrierEvent::add(EventLoop* event_loop) {
+  TriggeredEvent::add(event_loop);
+  if (timeout != 0 && timeout_event == nullptr) {
+    timeout_event = new TimeoutEvent(this, timeout);
+  }
+  if (remaining.load() == 0) {
+    // nothing to wait for
+    trigger();
+  } else {
+    startTimeout();
+  }
+}
+
+void BarrierEvent::remove(EventLoop* event_loop) {
+  if (timeout_event != nullptr) {
+    timeout_event->remove(event_loop);
+    timeout_event = nullptr;
+  }
+  TriggeredEvent::remove(event_loop);
+}
+
+void BarrierEvent::tick(EventLoop* event_loop) {
+  cancelTimeout();
+  barrier_cb(timed_out);
+}
+
+void BarrierEvent::reset() {
+  cancelTimeout();
+  timed_out = false;
+  remaining.store(count);
+  if (count == 0) {
+    trigger();
+  } else {
+    startTimeout();
+  }
+}
+
+void BarrierEvent::reset(uint32_t count) {
+  this->count = count;
+  reset();
+}
+
+// Position change for each (previous AB, current AB) state pair. Pairs
+// where both pins changed are invalid and map to 0.
+static const int8_t kQuadratureTable[16] = {0,  -1, 1, 0, 1, 0, 0,  -1,
+                                            -1, 0,  0, 1, 0, 1, -1, 0};
+
+void ICACHE_RAM_ATTR EncoderEvent::isr(void* this_ptr) {
+  auto* this_ = static_cast<EncoderEvent*>(this_ptr);
+  this_->update(digitalRead(this_->pin_a), digitalRead(this_->pin_b));
+}
+
+void ICACHE_RAM_ATTR EncoderEvent::update(bool a, bool b) {
+  const uint8_t new_state = (a << 1) | b;
+  const uint8_t index = (state << 2) | new_state;
+  state = new_state;
+  const int8_t step = kQuadratureTable[index];
+  if (step == 0) {
+    if ((index >> 2) != new_state) {
+      error_count++;
+    }
+    return;
+  }
+  position += step;
+  if (notify_interval_us == 0) {
+    trigger();
+  }
+}
+
+void EncoderEvent::attach() {
+#ifdef ESP32
+  ISREvent::addPinHandler(pin_a, EncoderEvent::isr, (void*)this);
+  ISREvent::addPinHandler(pin_b, EncoderEvent::isr, (void*)this);
+#elif defined(ESP8266)
+  attachInterruptArg(digitalPinToInterrupt(pin_a), EncoderEvent::isr,
+                     (void*)this, CHANGE);
+  attachInterruptArg(digitalPinToInterrupt(pin_b), EncoderEvent::isr,
+                     (void*)this, CHANGE);
+#endif
+}
+
+void EncoderEvent::detach() {
+#ifdef ESP32
+  ISREvent::removePinHandler(pin_a);
+  ISREvent::removePinHandler(pin_b);
+#elif defined(ESP8266)
+  detachInterrupt(digitalPinToInterrupt(pin_a));
+  detachInterrupt(digitalPinToInterrupt(pin_b));
+#endif
+}
+
+void EncoderEvent::report() {
+  const int32_t current = position.load();
+  if (current == reported_position) {
+    return;
+  }
+  const int32_t delta = current - reported_position;
+  reported_position = current;
+  encoder_cb(current, delta);
+}
+
+void EncoderEvent::add(EventLoop* event_loop) {
+  TriggeredEvent::add(event_loop);
+  state = (digitalRead(pin_a) << 1) | digitalRead(pin_b);
+  ISREvent::configurePin(pin_a, CHANGE);
+  ISREvent::configurePin(pin_b, CHANGE);
+  attach();
+  if (notify_interval_us != 0) {
+    notify_timer = event_loop->onRepeatMicros(notify_interval_us,
+                                              [this]() { this->report(); });
+  }
+}
+
+void EncoderEvent::remove(EventLoop* event_loop) {
+  detach();
+  if (notify_timer != nullptr) {
+    notify_timer->remove(event_loop);
+    notify_timer = nullptr;
+  }
+  TriggeredEvent::remove(event_loop);
+}
+
+void EncoderEvent::setPosition(int32_t new_position) {
+  position.store(new_position);
+  reported_position = new_position;
+}
+
+#ifdef ESP32
+PinGroupEvent* PinGroupEvent::first_group = nullptr;
+gpio_isr_handle_t PinGroupEvent::isr_handle = nullptr;
+CriticalSection PinGroupEvent::groups_lock;
+PinGroupEvent::PinHandler PinGroupEvent::pin_handlers[GPIO_PIN_COUNT] = {};
+uint64_t PinGroupEvent::pin_handler_mask = 0;
+
+void ICACHE_RAM_ATTR PinGroupEvent::gpioIsr(void* arg) {
+  const uint64_t status =
+      GPIO.status | ((uint64_t)GPIO.status1.intr_st << 32);
+  groups_lock.enter();
+  // only clear the status of the pins served here
+  uint64_t served = pin_handler_mask;
+  for (PinGroupEvent* group = first_group; group != nullptr;
+       group = group->next_group) {
+    served |= group->pin_mask;
+  }
+  const uint64_t changed = status & served;
+  GPIO.status_w1tc = (uint32_t)changed;
+  GPIO.status1_w1tc.intr_st = (uint32_t)(changed >> 32);
+  for (PinGroupEvent* group = first_group; group != nullptr;
+       group = group->next_group) {
+    const uint64_t mask = changed & group->pin_mask;
+    if (mask != 0) {
+      group->signal(mask);
+    }
+  }
+  groups_lock.exit();
+
+  uint64_t routed = changed & pin_handler_mask;
+  while (routed != 0) {
+    const int pin = __builtin_ctzll(routed);
+    routed &= routed - 1;
+    groups_lock.enter();
+    const PinHandler entry = pin_handlers[pin];
+    groups_lock.exit();
+    if (entry.handler != nullptr) {
+      entry.handler(entry.arg);
+    }
+  }
+}
+
+esp_err_t PinGroupEvent::routePinHandler(uint8_t pin_number,
+                                         gpio_isr_t handler, void* arg) {
+  if (pin_number >= GPIO_PIN_COUNT) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  groups_lock.enter();
+  if (isr_handle == nullptr) {
+    groups_lock.exit();
+    return ESP_ERR_INVALID_STATE;
+  }
+  pin_handlers[pin_number] = {handler, arg};
+  pin_handler_mask |= (uint64_t)1 << pin_number;
+  groups_lock.exit();
+  return ESP_OK;
+}
+
+void PinGroupEvent::unroutePinHandler(uint8_t pin_number) {
+  if (pin_number >= GPIO_PIN_COUNT) {
+    return;
+  }
+  const uint64_t bit = (uint64_t)1 << pin_number;
+  groups_lock.enter();
+  const bool routed = (pin_handler_mask & bit) != 0;
+  pin_handler_mask &= ~bit;
+  pin_handlers[pin_number] = {nullptr, nullptr};
+  groups_lock.exit();
+  if (routed) {
+    // the status of the pin is no longer cleared by anyone
+    gpio_set_intr_type((gpio_num_t)pin_number, GPIO_INTR_DISABLE);
+    releaseGpioInterrupt();
+  }
+}
+
+void PinGroupEvent::releaseGpioInterrupt() {
+  groups_lock.enter();
+  const bool unused = isr_handle != nullptr && first_group == nullptr &&
+                      pin_handler_mask == 0;
+  groups_lock.exit();
+  if (unused) {
+    esp_intr_free(isr_handle);
+    isr_handle = nullptr;
+  }
+}
+#endif
+
+void ICACHE_RAM_ATTR PinGroupEvent::pinIsr(void* pin_ptr) {
+  auto* pin = static_cast<Pin*>(pin_ptr);
+  pin->group->signal((uint64_t)1 << pin->pin_number);
+}
+
+void PinGroupEvent::add(EventLoop* event_loop) {
+  TriggeredEvent::add(event_loop);
+#ifdef ESP32
+  // fails if the GPIO ISR service has been installed
+  if (isr_handle == nullptr &&
+      gpio_isr_register(&PinGroupEvent::gpioIsr, nullptr, ESP_INTR_FLAG_LOWMED,
+                        &isr_handle) != ESP_OK) {
+    isr_handle = nullptr;
+  }
+  if (isr_handle != nullptr) {
+    shared_handler = true;
+    groups_lock.enter();
+    next_group = first_group;
+    first_group = this;
+    groups_lock.exit();
+  }
+#endif
+}
+
+void PinGroupEvent::attach(Pin* pin, int mode) {
+#ifdef ESP32
+  if (shared_handler) {
+    ISREvent::setInterruptType(pin->pin_number, mode);
+    groups_lock.enter();
+    pin_mask |= (uint64_t)1 << pin->pin_number;
+    groups_lock.exit();
+  } else {
+    ISREvent::configurePin(pin->pin_number, mode);
+    ISREvent::addPinHandler(pin->pin_number, &PinGroupEvent::pinIsr,
+                            (void*)pin);
+  }
+#elif defined(ESP8266)
+  attachInterruptArg(digitalPinToInterrupt(pin->pin_number),
+                     &PinGroupEvent::pinIsr, (void*)pin, mode);
+#endif
+}
+
+void PinGroupEvent::detach(Pin* pin) {
+#ifdef ESP32
+  if (shared_handler) {
+    gpio_set_intr_type((gpio_num_t)pin->pin_number, GPIO_INTR_DISABLE);
+  } else {
+    ISREvent::removePinHandler(pin->pin_number);
+  }
+#elif defined(ESP8266)
+  detachInterrupt(digitalPinToInterrupt(pin->pin_number));
+#endif
+}
+
+void PinGroupEvent::addPin(uint8_t pin_number, int mode,
+                           pin_group_callback callback) {
+  if (!enabled) {
+    // removed
+    return;
+  }
+  Pin* pin = new Pin{this, pin_number, callback};
+  pins.emplace_back(pin);
+  attach(pin, mode);
+}
+
+void ICACHE_RAM_ATTR PinGroupEvent::signal(uint64_t mask) {
+  const uint64_t now = micros64();
+  lock.enter();
+  if (pending_mask == 0) {
+    pending_timestamp = now;
+  }
+  pending_mask |= mask;
+  lock.exit();
+  trigger();
+}
+
+void PinGroupEvent::remove(EventLoop* event_loop) {
+  for (auto& pin : pins) {
+    detach(pin.get());
+  }
+#ifdef ESP32
+  if (shared_handler) {
+    groups_lock.enter();
+    PinGroupEvent** link = &first_group;
+    while (*link != this) {
+      link = &(*link)->next_group;
+    }
+    *link = next_group;
+    pin_mask = 0;
+    groups_lock.exit();
+    shared_handler = false;
+    releaseGpioInterrupt();
+  }
+#endif
+  // The pins are freed with the event: remove() may be called from a pin
+  // callback that is still running.
+  TriggeredEvent::remove(event_loop);
+}
+
+void PinGroupEvent::tick(EventLoop* event_loop) {
+  lock.enter();
+  const uint64_t mask = pending_mask;
+  const uint64_t timestamp = pending_timestamp;
+  pending_mask = 0;
+  lock.exit();
+  // by index, as the callbacks may add pins; the pins added are dispatched
+  // from the next tick on
+  const size_t count = pins.size();
+  for (size_t i = 0; i < count && enabled; i++) {
+    Pin* pin = pins[i].get();
+    if (mask & ((uint64_t)1 << pin->pin_number)) {
+      pin->callback(pin->pin_number, timestamp);
+    }
+  }
+}
+
 }  // namespace reactesp
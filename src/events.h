@@ -2,9 +2,21 @@
 #define REACTESP_SRC_EVENTS_H_
 
 #include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/event_groups.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+#ifdef ESP32
+#include <driver/gpio.h>
+#include <esp_timer.h>
+#endif
 
+#include <atomic>
 #include <functional>
 #include <memory>
+#include <vector>
+
+#include "critical_section.h"
 
 namespace reactesp {
 
@@ -23,6 +35,29 @@ inline uint64_t ICACHE_RAM_ATTR micros64() { return esp_timer_get_time(); }
 // forward declarations
 
 class EventLoop;
+class TriggeredEvent;
+
+/**
+ * @brief Statistics on how late events are triggered
+ */
+struct LatenessStats {
+  /// Number of recorded triggers
+  uint32_t count = 0;
+  /// Sum of the lateness of all triggers, in microseconds
+  uint64_t total = 0;
+  /// Maximum lateness, in microseconds
+  uint64_t max = 0;
+
+  void record(uint64_t lateness) {
+    count++;
+    total += lateness;
+    if (lateness > max) {
+      max = lateness;
+    }
+  }
+  uint64_t getAverage() const { return count == 0 ? 0 : total / count; }
+  void reset() { *this = LatenessStats(); }
+};
 
 /**
  * @brief EventInterface defines the interface for all events
@@ -78,6 +113,11 @@ class TimedEvent : public Event {
   const uint64_t interval;
   uint64_t last_trigger_time;
   bool enabled;
+  bool precise = false;
+  bool sheddable = false;
+  // occurrences skipped since the last run while shedding load
+  uint8_t shed_phase = 0;
+  uint16_t id = 0;
 
  public:
   /**
@@ -118,6 +158,42 @@ class TimedEvent : public Event {
     return (last_trigger_time + interval);
   }
   bool isEnabled() const { return enabled; }
+
+  /**
+   * @brief Set the event identifier used by schedule snapshots.
+   *
+   * Events with a zero id (the default) are not included in snapshots.
+   */
+  void setId(uint16_t id) { this->id = id; }
+  uint16_t getId() const { return id; }
+
+  /**
+   * @brief Enable the early-wake-and-spin precision mode.
+   *
+   * When the loop is run with EventLoop::tickBlocking(), it wakes up a
+   * calibrated margin before the trigger time of a precise event and
+   * busy-waits until the deadline, triggering the event within a few
+   * microseconds of getTriggerTimeMicros(). Spinning costs CPU time, so
+   * enable this only for events that need it.
+   */
+  void setPrecise(bool precise) { this->precise = precise; }
+  bool isPrecise() const { return precise; }
+
+  /**
+   * @brief Allow the event loop to skip occurrences of the event while it
+   *   is overloaded.
+   *
+   * Only affects repeating events. See EventLoop::enableOverloadDetection().
+   */
+  void setSheddable(bool sheddable) { this->sheddable = sheddable; }
+  bool isSheddable() const { return sheddable; }
+
+  /**
+   * @brief Return true if the event is re-armed after triggering
+   */
+  virtual bool isRepeating() const { return false; }
+
+  friend class EventLoop;
 };
 
 struct TriggerTimeCompare {
@@ -170,6 +246,143 @@ class RepeatEvent : public TimedEvent {
       : TimedEvent(interval, callback) {}
 
   void tick(EventLoop* event_loop) override;
+  bool isRepeating() const override { return true; }
+};
+
+/**
+ * @brief Repeating event dispatched by a high-resolution hardware timer
+ *
+ * The precision of a RepeatEvent is bounded by how often the loop calls
+ * tick(). On ESP32, a PreciseRepeatEvent is instead dispatched by an
+ * esp_timer, so it triggers on time even when other callbacks keep the
+ * loop busy. On other platforms, it behaves like a RepeatEvent.
+ *
+ * The callback runs in the esp_timer task, concurrently with the event
+ * loop. It must be short and must synchronize any state it shares with
+ * loop callbacks.
+ */
+class PreciseRepeatEvent : public RepeatEvent {
+ private:
+  LatenessStats lateness;
+#ifdef ESP32
+  esp_timer_handle_t timer = nullptr;
+  // one-shot timer that frees the object after removal
+  esp_timer_handle_t release_timer = nullptr;
+  SemaphoreHandle_t mutex_;
+  // the time the next callback is due, in microseconds
+  uint64_t due_time = 0;
+
+  static void dispatch(void* this_ptr);
+  static void release(void* this_ptr);
+#endif
+
+ public:
+  /**
+   * @brief Construct a new Precise Repeat Event object
+   *
+   * @param interval Repetition interval, in milliseconds
+   * @param callback Function to be called at every repetition
+   */
+  PreciseRepeatEvent(uint32_t interval, react_callback callback);
+  /**
+   * @brief Construct a new Precise Repeat Event object
+   *
+   * @param interval Repetition interval, in microseconds
+   * @param callback Function to be called at every repetition
+   */
+  PreciseRepeatEvent(uint64_t interval, react_callback callback);
+
+#ifdef ESP32
+  ~PreciseRepeatEvent() override;
+
+  void add(EventLoop* event_loop) override;
+  void remove(EventLoop* event_loop) override;
+#else
+  void tick(EventLoop* event_loop) override;
+#endif
+
+  /**
+   * @brief Return the lateness statistics of the callback invocations
+   */
+  LatenessStats getLatenessStats();
+
+  using EventInterface::add;
+  using EventInterface::remove;
+  using EventInterface::tick;
+};
+
+/// EventDescriptor flag: run the event on the first tick after the table
+/// is added instead of one interval later
+#define REACTESP_DESCRIPTOR_RUN_AT_START 0x01
+
+/**
+ * @brief Immutable description of a repeating event
+ *
+ * Descriptor tables are meant to be declared const (and PROGMEM on
+ * ESP8266) so that they stay in flash. The name, if any, should also be
+ * a flash string.
+ */
+struct EventDescriptor {
+  /// Repetition interval, in milliseconds
+  uint32_t interval;
+  /// Function called at every repetition
+  void (*function)();
+  /// Name used by DescriptorTableEvent::find(), or nullptr
+  const char* name;
+  /// Flags of the entry, a combination of REACTESP_DESCRIPTOR_* values
+  uint8_t flags;
+};
+
+// 16 bytes of flash per entry on the 32-bit targets
+static_assert(sizeof(EventDescriptor) == 4 * sizeof(void*),
+              "unexpected EventDescriptor size");
+
+/**
+ * @brief Event running a table of repeating events described by
+ *   EventDescriptor entries
+ *
+ * The descriptors are read from flash when the event runs; the only
+ * per-entry RAM is a 32-bit millisecond deadline, compared with the low
+ * 32 bits of the current time in wraparound-safe arithmetic. The whole
+ * table is a single entry in the timed queue, triggered at the earliest
+ * deadline.
+ */
+class DescriptorTableEvent : public TimedEvent {
+ private:
+  const EventDescriptor* const table;
+  const size_t count;
+  uint32_t* const deadlines;
+
+  void schedule(uint64_t now);
+
+ public:
+  /**
+   * @brief Construct a new DescriptorTableEvent object
+   *
+   * @param table Descriptor table
+   * @param count Number of entries in the table
+   */
+  DescriptorTableEvent(const EventDescriptor* table, size_t count);
+  ~DescriptorTableEvent() override { delete[] deadlines; }
+
+  void add(EventLoop* event_loop) override;
+  void tick(EventLoop* event_loop) override;
+  bool isRepeating() const override { return true; }
+
+  using EventInterface::add;
+  using EventInterface::remove;
+  using EventInterface::tick;
+
+  size_t size() const { return count; }
+  /**
+   * @brief Return the index of the entry with the given name, or -1
+   */
+  int find(const char* name) const;
+  /**
+   * @brief Return the time of the next run of an entry, in milliseconds
+   *   since boot, modulo 2^32
+   */
+  uint32_t getDeadline(size_t index) const { return deadlines[index]; }
 };
 
 /**
@@ -185,15 +398,31 @@ class UntimedEvent : public Event {
   using EventInterface::add;
   using EventInterface::remove;
   using EventInterface::tick;
+
+ protected:
+  /**
+   * @brief Take the event out of the untimed list without deleting it
+   */
+  void unlink(EventLoop* event_loop);
 };
 
 /**
  * @brief Event that is triggered when there is input available at the given
  *   Arduino Stream
+ *
+ * In notify-driven mode, the event is not in the untimed event list: it is
+ * run through an internal TriggeredEvent, so it does not keep
+ * EventLoop::tickBlocking() from blocking.
  */
 class StreamEvent : public UntimedEvent {
  private:
   Stream& stream;
+  bool notify_driven = false;
+  EventLoop* event_loop = nullptr;
+  // runs check() in notify-driven mode
+  TriggeredEvent* notifier = nullptr;
+
+  void check();
 
  public:
   /**
@@ -205,7 +434,145 @@ class StreamEvent : public UntimedEvent {
   StreamEvent(Stream& stream, react_callback callback)
       : UntimedEvent(callback), stream(stream) {}
 
+  void add(EventLoop* event_loop) override;
+  void remove(EventLoop* event_loop) override;
+  void tick(EventLoop* event_loop) override;
+
+  using EventInterface::add;
+  using EventInterface::remove;
+  using EventInterface::tick;
+
+  /**
+   * @brief Select between polling and notify-driven operation
+   *
+   * By default, the stream is polled with available() on every tick. In
+   * notify-driven mode, the stream is only checked after notify() has been
+   * called, typically from a driver receive hook, and for as long as input
+   * remains after the callback returns. Do not call this from the event's
+   * own callback.
+   *
+   * @param notify_driven true to enable the notify-driven mode
+   */
+  void setNotifyDriven(bool notify_driven);
+  bool isNotifyDriven() const { return notify_driven; }
+
+  /**
+   * @brief Signal that new input is available and wake up the event loop
+   *
+   * Safe to call from other tasks and from interrupt handlers.
+   */
+  void ICACHE_RAM_ATTR notify();
+};
+
+/**
+ * @brief Event that monitors a set of Arduino Streams for available input
+ *
+ * All streams are checked in a single pass per tick. Streams that had
+ * input on the previous pass are served first. Idle streams are polled
+ * less and less often: the polling interval doubles for every pass without
+ * input, up to max_backoff ticks, and returns to every tick as soon as
+ * input arrives. This bounds the cost of idle streams at the price of up
+ * to max_backoff ticks of extra latency for the first byte after an idle
+ * period.
+ */
+class StreamMuxEvent : public UntimedEvent {
+ private:
+  struct Entry {
+    Stream* stream;
+    react_callback callback;
+    // current polling interval and ticks remaining until the next poll
+    uint16_t interval;
+    uint16_t countdown;
+    // true if the stream had input on the previous poll
+    bool active;
+    // true if the stream was polled in the first pass of the current tick
+    bool served;
+  };
+
+  std::vector<Entry> entries;
+  // streams added by callbacks during a tick, appended after it
+  std::vector<Entry> added;
+  bool ticking = false;
+  const uint16_t max_backoff;
+  uint32_t poll_count = 0;
+
+  bool poll(Entry& entry);
+
+ public:
+  /**
+   * @brief Construct a new Stream Mux Event object
+   *
+   * @param max_backoff Maximum polling interval of idle streams, in ticks
+   */
+  StreamMuxEvent(uint16_t max_backoff)
+      : UntimedEvent(nullptr), max_backoff(max_backoff > 0 ? max_backoff : 1) {}
+
+  /**
+   * @brief Add a stream to monitor
+   *
+   * May be called from a callback of this event. The new stream is first
+   * polled on the next tick.
+   *
+   * @param stream Stream to monitor
+   * @param callback Callback to call for new input
+   */
+  void addStream(Stream& stream, react_callback callback);
+
+  void tick(EventLoop* event_loop) override;
+
+  /**
+   * @brief Return the number of available() calls made so far
+   */
+  uint32_t getPollCount() const { return poll_count; }
+  size_t getStreamCount() const { return entries.size() + added.size(); }
+};
+
+/**
+ * @brief Event that is triggered when the given Arduino Stream can accept
+ *   at least a given number of bytes without blocking
+ *
+ * The event is level-triggered: the callback is called on every tick while
+ * there is enough space. Disable the event while there is nothing to send.
+ * A disabled event is taken out of the untimed event list, so it does not
+ * keep EventLoop::tickBlocking() from blocking.
+ */
+class WritableEvent : public UntimedEvent {
+ private:
+  Stream& stream;
+  const int min_space;
+  bool enabled = true;
+  EventLoop* event_loop = nullptr;
+
+ public:
+  /**
+   * @brief Construct a new Writable Event object
+   *
+   * @param stream Stream to monitor
+   * @param min_space Minimum number of bytes that availableForWrite() must
+   *   report before the callback is called
+   * @param callback Callback to call when there is space to write
+   */
+  WritableEvent(Stream& stream, int min_space, react_callback callback)
+      : UntimedEvent(callback), stream(stream), min_space(min_space) {}
+
+  void add(EventLoop* event_loop) override;
   void tick(EventLoop* event_loop) override;
+
+  using EventInterface::add;
+  using EventInterface::remove;
+  using EventInterface::tick;
+
+  /**
+   * @brief Resume calling the callback when there is space to write
+   */
+  void enable();
+  /**
+   * @brief Stop calling the callback, e.g. while there is nothing to send
+   *
+   * May be called from the callback.
+   */
+  void disable();
+  bool isEnabled() const { return enabled; }
 };
 
 /**
@@ -223,18 +590,214 @@ class TickEvent : public UntimedEvent {
   void tick(EventLoop* event_loop) override;
 };
 
+/**
+ * @brief Event that is triggered explicitly by calling trigger()
+ *
+ * The callback is called once by the event loop after trigger() has been
+ * called, no matter how many times trigger() was called in between. The
+ * event loop does not poll triggered events; they cost nothing until
+ * triggered.
+ */
+class TriggeredEvent : public Event {
+  friend class EventLoop;
+
+ protected:
+  EventLoop* event_loop = nullptr;
+  std::atomic<bool> pending;
+  bool enabled = true;
+  // link in the event loop's list of pending events
+  TriggeredEvent* next_pending = nullptr;
+
+ public:
+  /**
+   * @brief Construct a new Triggered Event object
+   *
+   * @param callback Function to be called after the event is triggered
+   */
+  TriggeredEvent(react_callback callback) : Event(callback), pending(false) {}
+
+  void add(EventLoop* event_loop) override;
+  void remove(EventLoop* event_loop) override;
+  void tick(EventLoop* event_loop) override;
+
+  using EventInterface::add;
+  using EventInterface::remove;
+  using EventInterface::tick;
+
+  /**
+   * @brief Schedule the callback to be called by the event loop.
+   *
+   * Safe to call from other tasks and from interrupt handlers.
+   */
+  void ICACHE_RAM_ATTR trigger();
+
+  bool isPending() const { return pending.load(); }
+  bool isEnabled() const { return enabled; }
+};
+
+/**
+ * @brief Events that are triggered by a FreeRTOS synchronization object
+ *
+ * Queues and semaphores are added to the event loop's queue set, so that
+ * a loop waiting in EventLoop::tickBlocking() wakes up when they are
+ * signalled. Objects that cannot be added to the queue set are polled,
+ * limiting the blocking time to REACTESP_RTOS_POLL_MS milliseconds. On
+ * every tick, the objects are checked with non-blocking calls; no
+ * per-object tick events are needed.
+ */
+class RTOSEvent : public Event {
+  friend class EventLoop;
+
+ public:
+  RTOSEvent(react_callback callback) : Event(callback) {}
+
+  void add(EventLoop* event_loop) override;
+  void remove(EventLoop* event_loop) override;
+  void tick(EventLoop* event_loop) override {}
+
+  using EventInterface::add;
+  using EventInterface::remove;
+  using EventInterface::tick;
+
+ protected:
+  /**
+   * @brief Return the queue set member handle, or nullptr if the object
+   * cannot be waited on and has to be polled.
+   */
+  virtual QueueSetMemberHandle_t getSetMember() const { return nullptr; }
+  /**
+   * @brief Check the object and call the callback if it has been signalled
+   *
+   * @return true if the callback was called
+   */
+  virtual bool poll() = 0;
+
+  // number of queue set slots used by the object; zero if the object is
+  // not in the event loop's queue set
+  size_t queue_set_slots = 0;
+  // number of queue set entries for the object since the last poll
+  uint32_t signalled = 0;
+};
+
+/**
+ * @brief Event that is triggered when a FreeRTOS queue has items
+ *
+ * The callback is called once for each item and should receive exactly one
+ * item with a zero timeout. Only the event loop may receive from the queue:
+ * the loop waits on it through a queue set that holds one entry per item
+ * sent, and items received by other tasks would leave entries behind that
+ * can overflow the set.
+ */
+class QueueEvent : public RTOSEvent {
+ private:
+  const QueueHandle_t queue;
+
+ public:
+  /**
+   * @brief Construct a new Queue Event object
+   *
+   * @param queue Queue to monitor. It must be empty when the event is added
+   *   for the loop to be able to wait on it.
+   * @param callback Function to be called when the queue has items
+   */
+  QueueEvent(QueueHandle_t queue, react_callback callback)
+      : RTOSEvent(callback), queue(queue) {}
+
+ protected:
+  QueueSetMemberHandle_t getSetMember() const override { return queue; }
+  bool poll() override;
+};
+
+/**
+ * @brief Event that is triggered when a FreeRTOS semaphore is given
+ *
+ * The event takes the semaphore and calls the callback once for every
+ * give. As with QueueEvent, only the event loop may take the semaphore.
+ */
+class SemaphoreEvent : public RTOSEvent {
+ private:
+  const SemaphoreHandle_t semaphore;
+
+ public:
+  /**
+   * @brief Construct a new Semaphore Event object
+   *
+   * @param semaphore Binary or counting semaphore to monitor. It must not
+   *   be available when the event is added for the loop to be able to wait
+   *   on it.
+   * @param callback Function to be called when the semaphore is given
+   */
+  SemaphoreEvent(SemaphoreHandle_t semaphore, react_callback callback)
+      : RTOSEvent(callback), semaphore(semaphore) {}
+
+ protected:
+  QueueSetMemberHandle_t getSetMember() const override { return semaphore; }
+  bool poll() override;
+};
+
+using event_bits_callback = std::function<void(EventBits_t)>;
+
+/**
+ * @brief Event that is triggered when bits are set in a FreeRTOS event group
+ *
+ * Event groups cannot be waited on together with other objects, so they
+ * are polled. While event bits events exist, EventLoop::tickBlocking()
+ * blocks at most REACTESP_RTOS_POLL_MS milliseconds at a time. Call
+ * EventLoop::wake() after setting the bits for an immediate response.
+ */
+class EventBitsEvent : public RTOSEvent {
+ private:
+  const EventGroupHandle_t event_group;
+  const EventBits_t bits;
+  const bool clear_on_trigger;
+  const event_bits_callback bits_callback;
+
+ public:
+  /**
+   * @brief Construct a new Event Bits Event object
+   *
+   * @param event_group Event group to monitor
+   * @param bits Bits to monitor. The event triggers if any of them is set.
+   * @param callback Function to be called with the set bits
+   * @param clear_on_trigger Clear the bits before calling the callback
+   */
+  EventBitsEvent(EventGroupHandle_t event_group, EventBits_t bits,
+                 event_bits_callback callback, bool clear_on_trigger = true)
+      : RTOSEvent(nullptr),
+        event_group(event_group),
+        bits(bits),
+        clear_on_trigger(clear_on_trigger),
+        bits_callback(callback) {}
+
+ protected:
+  bool poll() override;
+};
+
 /**
  * @brief Event that is triggered on an input pin change
  */
 class ISREvent : public Event {
  private:
-  const uint8_t pin_number;
-  const int mode;
 #ifdef ESP32
-  // set to true once gpio_install_isr_service is called
+  // set to true once the GPIO ISR service has been installed
   static bool isr_service_installed;
-  static void isr(void* this_ptr);
+
+  static void installIsrService();
 #endif
+  static void ICACHE_RAM_ATTR isr(void* this_ptr);
+
+  void attach();
+  void detach();
+
+ protected:
+  const uint8_t pin_number;
+  const int mode;
+  bool enabled = true;
+
+  /**
+   * @brief Handle the interrupt. Runs in interrupt context.
+   */
+  virtual void ICACHE_RAM_ATTR interrupt() { callback(); }
 
  public:
   /**
@@ -247,35 +810,473 @@ class ISREvent : public Event {
    */
   ISREvent(uint8_t pin_number, int mode, react_callback callback)
       : Event(callback), pin_number(pin_number), mode(mode) {
+    configurePin(pin_number, mode);
+  }
+
+  /**
+   * @brief Set the interrupt type of a pin and install the GPIO interrupt
+   *   service if needed
+   *
+   * Used by events that attach their own interrupt handlers.
+   */
+  static void configurePin(uint8_t pin_number, int mode);
+  /**
+   * @brief Set the interrupt type of a pin without installing the GPIO
+   *   interrupt service
+   */
+  static void setInterruptType(uint8_t pin_number, int mode);
 #ifdef ESP32
-    gpio_int_type_t intr_type;
-    switch (mode) {
-      case RISING:
-        intr_type = GPIO_INTR_POSEDGE;
-        break;
-      case FALLING:
-        intr_type = GPIO_INTR_NEGEDGE;
-        break;
-      case CHANGE:
-        intr_type = GPIO_INTR_ANYEDGE;
-        break;
-      default:
-        intr_type = GPIO_INTR_DISABLE;
-        break;
-    }
-    // configure the IO pin
-    gpio_set_intr_type((gpio_num_t)pin_number, intr_type);
+  /**
+   * @brief Attach an interrupt handler to a pin configured with
+   *   configurePin()
+   *
+   * The handler is added to the GPIO ISR service. If the shared handler of
+   * the pin groups owns the GPIO interrupt, the service cannot be installed
+   * and the handler is called from the shared handler instead.
+   *
+   * @return ESP_OK, or the error returned by the GPIO driver
+   */
+  static esp_err_t addPinHandler(uint8_t pin_number, gpio_isr_t handler,
+                                 void* arg);
+  /**
+   * @brief Detach the handler attached with addPinHandler()
+   */
+  static void removePinHandler(uint8_t pin_number);
+#endif
+
+  /**
+   * @brief Destroy the ISREvent object, detaching the interrupt handler
+   *
+   * remove() detaches the handler before deleting the event, so that no
+   * interrupt is taken while a derived event is being destroyed.
+   */
+  ~ISREvent() override { detach(); }
+
+  void add(EventLoop* event_loop) override;
+  void remove(EventLoop* event_loop) override;
+  void tick(EventLoop* event_loop) override {}
+
+  /**
+   * @brief Unmask the pin interrupt after disable()
+   */
+  void enable();
+  /**
+   * @brief Mask the pin interrupt without removing the event
+   *
+   * Unlike removing and recreating the event, disabling and enabling
+   * it is O(1) and does not allocate memory.
+   */
+  void disable();
+  bool isEnabled() const { return enabled; }
+};
+
+/**
+ * @brief Pulse statistics over one measurement window
+ */
+struct PulseStats {
+  /// Number of complete periods (rising edge to rising edge)
+  uint32_t period_count = 0;
+  /// Average frequency in Hz, or 0 if no complete period was seen
+  float frequency = 0;
+  float average_period_us = 0;
+  uint32_t min_period_us = 0;
+  uint32_t max_period_us = 0;
+  /// Average high time, or 0 if pulse widths are not measured
+  float average_width_us = 0;
+  /// Average high time divided by the average period
+  float duty_cycle = 0;
+};
 
-    if (!isr_service_installed) {
-      isr_service_installed = true;
-      gpio_install_isr_service(ESP_INTR_FLAG_LOWMED);
+using pulse_callback = std::function<void(const PulseStats& stats)>;
+
+/**
+ * @brief Event that measures the frequency and pulse width of a signal
+ *
+ * The interrupt handler timestamps the edges and accumulates period and
+ * pulse width statistics. Once per window, the statistics are delivered
+ * to the callback from the event loop and reset, so the loop handles one
+ * callback per window instead of one per edge.
+ */
+class PulseEvent : public ISREvent {
+ private:
+  const uint32_t window_ms;
+  const pulse_callback pulse_cb;
+  RepeatEvent* window_timer = nullptr;
+  CriticalSection lock;
+
+  // accumulators, guarded by lock
+  uint64_t last_rising = 0;
+  uint32_t period_count = 0;
+  uint64_t period_sum = 0;
+  uint32_t min_period = UINT32_MAX;
+  uint32_t max_period = 0;
+  uint32_t width_count = 0;
+  uint64_t width_sum = 0;
+
+  void report();
+
+ protected:
+  void ICACHE_RAM_ATTR interrupt() override;
+
+ public:
+  /**
+   * @brief Construct a new PulseEvent object
+   *
+   * @param pin_number GPIO pin of the measured signal
+   * @param window_ms Length of the measurement window
+   * @param callback Function called from the event loop with the statistics
+   *   of each window
+   * @param measure_width If true, interrupts are taken on both edges and
+   *   the pulse width and duty cycle are measured. If false, only rising
+   *   edges interrupt and only the frequency is measured.
+   */
+  PulseEvent(uint8_t pin_number, uint32_t window_ms, pulse_callback callback,
+             bool measure_width = true)
+      : ISREvent(pin_number, measure_width ? CHANGE : RISING, nullptr),
+        window_ms(window_ms),
+        pulse_cb(callback) {}
+
+  void add(EventLoop* event_loop) override;
+  void remove(EventLoop* event_loop) override;
+
+  using EventInterface::add;
+  using EventInterface::remove;
+  using EventInterface::tick;
+
+  /**
+   * @brief Record an edge
+   *
+   * Called by the interrupt handler. Can also be called with simulated
+   * edges.
+   *
+   * @param level Signal level after the edge
+   * @param timestamp Time of the edge in microseconds
+   */
+  void ICACHE_RAM_ATTR edge(bool level, uint64_t timestamp);
+};
+
+using barrier_callback = std::function<void(bool timed_out)>;
+
+/**
+ * @brief Event that fires once a number of arrivals have been signalled
+ *
+ * The arrivals are counted down in a single atomic counter; the arrival
+ * that brings it to zero triggers the event, so the event is never polled.
+ * If a timeout is set and expires first, the event fires with timed_out
+ * set and later arrivals are ignored. The event fires once; call reset()
+ * to wait for another round of arrivals. The timeout uses a single timer
+ * event that is created when the barrier is added and re-armed every
+ * round, so the rounds do not allocate.
+ */
+class BarrierEvent : public TriggeredEvent {
+ private:
+  /**
+   * @brief Timed event owned by a BarrierEvent that expires its rounds
+   *
+   * The timer stays in the timed queue while a round is waiting. Restarting
+   * it only moves the deadline; if the timer comes due before the deadline
+   * it is queued again for the remaining time.
+   */
+  class TimeoutEvent : public TimedEvent {
+   private:
+    BarrierEvent* const barrier;
+    // deadline of the current round in microseconds, 0 if disarmed
+    uint64_t deadline = 0;
+    // true while the timer is in the timed queue
+    bool queued = false;
+
+   public:
+    TimeoutEvent(BarrierEvent* barrier, uint32_t timeout)
+        : TimedEvent(timeout, nullptr), barrier(barrier) {}
+
+    void tick(EventLoop* event_loop) override;
+    void remove(EventLoop* event_loop) override;
+
+    using EventInterface::remove;
+    using EventInterface::tick;
+
+    void start(EventLoop* event_loop);
+    void cancel() { deadline = 0; }
+  };
+
+  uint32_t count;
+  const uint32_t timeout;
+  const barrier_callback barrier_cb;
+  std::atomic<uint32_t> remaining;
+  bool timed_out = false;
+  TimeoutEvent* timeout_event = nullptr;
+
+  void startTimeout();
+  void cancelTimeout();
+  void expire();
+
+ public:
+  /**
+   * @brief Construct a new BarrierEvent object
+   *
+   * @param count Number of arrivals to wait for. With 0, the event fires
+   *   as soon as it is added.
+   * @param callback Function called from the event loop when all arrivals
+   *   have been signalled or the timeout has expired
+   * @param timeout Timeout in milliseconds, measured from adding or
+   *   resetting the event. 0 disables the timeout.
+   */
+  BarrierEvent(uint32_t count, barrier_callback callback, uint32_t timeout = 0)
+      : TriggeredEvent(nullptr),
+        count(count),
+        timeout(timeout),
+        barrier_cb(callback),
+        remaining(count) {}
+
+  void add(EventLoop* event_loop) override;
+  void remove(EventLoop* event_loop) override;
+  void tick(EventLoop* event_loop) override;
+
+  using EventInterface::add;
+  using EventInterface::remove;
+  using EventInterface::tick;
+
+  /**
+   * @brief Signal one arrival
+   *
+   * Safe to call from other tasks and from interrupt handlers. Arrivals
+   * after the counter has reached zero are ignored.
+   */
+  void ICACHE_RAM_ATTR arrive() {
+    uint32_t value = remaining.load();
+    while (value != 0) {
+      if (remaining.compare_exchange_weak(value, value - 1)) {
+        if (value == 1) {
+          trigger();
+        }
+        return;
+      }
     }
-#endif
   }
 
+  /**
+   * @brief Wait for a new round of the same number of arrivals
+   *
+   * Restarts the timeout. Call from the event loop task once the previous
+   * round has fired.
+   */
+  void reset();
+
+  /**
+   * @brief Wait for a new round with a new number of arrivals
+   *
+   * @param count Number of arrivals to wait for. With 0, the event fires
+   *   again on the next tick without waiting.
+   */
+  void reset(uint32_t count);
+
+  /**
+   * @brief Return the number of arrivals still missing
+   */
+  uint32_t getRemaining() const { return remaining.load(); }
+};
+
+using encoder_callback = std::function<void(int32_t position, int32_t delta)>;
+
+/**
+ * @brief Event that decodes a quadrature encoder
+ *
+ * Both encoder pins share a single short interrupt handler that reads the
+ * pin levels, decodes the transition with a lookup table and updates an
+ * atomic position counter. The callback is called from the event loop
+ * either when the position has changed or at a fixed rate, with the
+ * position and the change since the previous call.
+ */
+class EncoderEvent : public TriggeredEvent {
+ private:
+  const uint8_t pin_a;
+  const uint8_t pin_b;
+  const uint32_t notify_interval_us;
+  const encoder_callback encoder_cb;
+  std::atomic<int32_t> position;
+  std::atomic<uint32_t> error_count;
+  // previous AB state, only accessed by update()
+  uint8_t state = 0;
+  int32_t reported_position = 0;
+  RepeatEvent* notify_timer = nullptr;
+
+  static void ICACHE_RAM_ATTR isr(void* this_ptr);
+
+  void attach();
+  void detach();
+  void report();
+
+ public:
+  /**
+   * @brief Construct a new EncoderEvent object
+   *
+   * The pins must be configured as inputs before the event is added.
+   *
+   * @param pin_a GPIO pin of encoder channel A
+   * @param pin_b GPIO pin of encoder channel B
+   * @param callback Function called from the event loop with the position
+   *   and the change since the previous call
+   * @param notify_interval_us If 0, the callback is called on the next tick
+   *   after the position changes. Otherwise, the position is checked at
+   *   this interval and the callback is called if it has changed.
+   */
+  EncoderEvent(uint8_t pin_a, uint8_t pin_b, encoder_callback callback,
+               uint32_t notify_interval_us = 0)
+      : TriggeredEvent(nullptr),
+        pin_a(pin_a),
+        pin_b(pin_b),
+        notify_interval_us(notify_interval_us),
+        encoder_cb(callback),
+        position(0),
+        error_count(0) {}
+
   void add(EventLoop* event_loop) override;
   void remove(EventLoop* event_loop) override;
-  void tick(EventLoop* event_loop) override {}
+  void tick(EventLoop* event_loop) override { report(); }
+
+  using EventInterface::add;
+  using EventInterface::remove;
+  using EventInterface::tick;
+
+  /**
+   * @brief Decode a new pin state
+   *
+   * Called by the interrupt handler. Can also be called with simulated pin
+   * levels.
+   */
+  void ICACHE_RAM_ATTR update(bool a, bool b);
+
+  int32_t getPosition() const { return position.load(); }
+  /**
+   * @brief Set the position without calling the callback
+   *
+   * Call from the event loop task only.
+   */
+  void setPosition(int32_t new_position);
+  /**
+   * @brief Return the number of invalid transitions, in which both pins
+   *   changed at once
+   */
+  uint32_t getErrorCount() const { return error_count.load(); }
+};
+
+using pin_group_callback = std::function<void(uint8_t pin, uint64_t timestamp)>;
+
+/**
+ * @brief Event that dispatches the interrupts of a group of pins from the
+ *   event loop
+ *
+ * The interrupt handler only records the changed pins in a shared change
+ * bitmask, along with the time of the first change, and triggers the
+ * event. The event loop then calls the callbacks of all changed pins in
+ * one pass. Multiple edges on a pin between two loop iterations result in
+ * a single callback call.
+ *
+ * On ESP32, all groups share one GPIO interrupt handler, installed with
+ * gpio_isr_register(), that reads the interrupt status registers once per
+ * interrupt and clears the bits of the pins it serves. The GPIO ISR
+ * service used by attachInterrupt() claims the same interrupt, so the
+ * order in which the events are added matters:
+ *
+ * - If the service is installed first, by an ISREvent, EncoderEvent or
+ *   attachInterrupt(), a group added later attaches a handler to each of
+ *   its pins through the service.
+ * - If a group is added first, the shared handler owns the interrupt
+ *   until all groups and the pins below are removed. ISREvent and
+ *   EncoderEvent pins added meanwhile are served by the shared handler
+ *   too. attachInterrupt() is not supported in that case.
+ *
+ * Elsewhere, each pin has its own handler.
+ *
+ * Callbacks may call addPin() and remove(). Pins added by a callback are
+ * dispatched from the next tick on, and removing the group stops the
+ * dispatch of the current tick.
+ */
+class PinGroupEvent : public TriggeredEvent {
+ private:
+  struct Pin {
+    PinGroupEvent* group;
+    uint8_t pin_number;
+    pin_group_callback callback;
+  };
+
+  // allocated separately, as the per-pin handlers refer to them
+  std::vector<std::unique_ptr<Pin>> pins;
+  // changed pins and the time of the first change, guarded by a critical
+  // section
+  uint64_t pending_mask = 0;
+  uint64_t pending_timestamp = 0;
+  CriticalSection lock;
+
+#ifdef ESP32
+  // pins of the group, read by the shared handler
+  uint64_t pin_mask = 0;
+  // true if the group is served by the shared handler
+  bool shared_handler = false;
+  PinGroupEvent* next_group = nullptr;
+
+  struct PinHandler {
+    gpio_isr_t handler;
+    void* arg;
+  };
+
+  // groups served by the shared handler, guarded by groups_lock
+  static PinGroupEvent* first_group;
+  static gpio_isr_handle_t isr_handle;
+  static CriticalSection groups_lock;
+  // per-pin handlers served by the shared handler, guarded by groups_lock
+  static PinHandler pin_handlers[GPIO_PIN_COUNT];
+  static uint64_t pin_handler_mask;
+
+  static void ICACHE_RAM_ATTR gpioIsr(void* arg);
+  static bool ownsGpioInterrupt() { return isr_handle != nullptr; }
+  static esp_err_t routePinHandler(uint8_t pin_number, gpio_isr_t handler,
+                                   void* arg);
+  static void unroutePinHandler(uint8_t pin_number);
+  // free the shared handler once no group or pin uses it
+  static void releaseGpioInterrupt();
+
+  friend class ISREvent;
+#endif
+  static void ICACHE_RAM_ATTR pinIsr(void* pin_ptr);
+
+  void attach(Pin* pin, int mode);
+  void detach(Pin* pin);
+
+ public:
+  PinGroupEvent() : TriggeredEvent(nullptr) {}
+
+  /**
+   * @brief Add a pin to the group
+   *
+   * The event must have been added to an event loop first.
+   *
+   * @param pin_number GPIO pin number (0-63)
+   * @param mode Interrupt mode. One of RISING, FALLING, CHANGE
+   * @param callback Function called from the event loop with the pin number
+   *   and the time of the first change of any pin in the group since the
+   *   previous dispatch, in microseconds
+   */
+  void addPin(uint8_t pin_number, int mode, pin_group_callback callback);
+
+  /**
+   * @brief Record pin changes and trigger the event
+   *
+   * Called by the pin interrupt handlers. Can also be called with a
+   * pin-change status register value read by a custom interrupt handler,
+   * or with a simulated one.
+   *
+   * @param mask Bitmask of changed pins, bit n corresponding to GPIO n
+   */
+  void ICACHE_RAM_ATTR signal(uint64_t mask);
+
+  void add(EventLoop* event_loop) override;
+  void remove(EventLoop* event_loop) override;
+  void tick(EventLoop* event_loop) override;
+
+  using EventInterface::add;
+  using EventInterface::remove;
+  using EventInterface::tick;
 };
 
 }  // namespace reactesp
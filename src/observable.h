@@ -0,0 +1,97 @@
+#ifndef REACTESP_SRC_OBSERVABLE_H_
+#define REACTESP_SRC_OBSERVABLE_H_
+
+#include <functional>
+#include <vector>
+
+#include "event_loop.h"
+#include "events.h"
+
+namespace reactesp {
+
+/**
+ * @brief A value whose changes are propagated to observers by the event loop
+ *
+ * Calling set() stores the new value and triggers a notification that is
+ * delivered by the event loop. Any number of set() calls between two loop
+ * ticks result in a single notification carrying the latest value, so
+ * observers never recompute for intermediate values they would not see.
+ *
+ * @code
+ * Observable<float> temperature(&event_loop);
+ * temperature.attach([](const float& t) { Serial.println(t); });
+ * event_loop.onRepeat(100, []() { temperature.set(read_sensor()); });
+ * @endcode
+ *
+ * set() must be called from the event loop task.
+ */
+template <typename T>
+class Observable {
+ public:
+  using observer_callback = std::function<void(const T&)>;
+
+  /**
+   * @brief Construct a new Observable object
+   *
+   * @param event_loop Event loop delivering the notifications
+   * @param value Initial value
+   */
+  Observable(EventLoop* event_loop, const T& value = T())
+      : event_loop(event_loop), value(value) {
+    notifier = event_loop->onTrigger([this]() { notify(); });
+  }
+
+  ~Observable() { notifier->remove(event_loop); }
+
+  Observable(const Observable&) = delete;
+  Observable& operator=(const Observable&) = delete;
+
+  /**
+   * @brief Set a new value and schedule the observers to be notified
+   */
+  void set(const T& new_value) {
+    value = new_value;
+    set_count++;
+    notifier->trigger();
+  }
+
+  Observable& operator=(const T& new_value) {
+    set(new_value);
+    return *this;
+  }
+
+  const T& get() const { return value; }
+
+  /**
+   * @brief Add an observer to be called with the latest value after changes
+   */
+  void attach(observer_callback observer) { observers.push_back(observer); }
+
+  /**
+   * @brief Return the number of set() calls
+   */
+  uint32_t getSetCount() const { return set_count; }
+  /**
+   * @brief Return the number of notifications delivered to the observers
+   */
+  uint32_t getNotifyCount() const { return notify_count; }
+
+ protected:
+  void notify() {
+    notify_count++;
+    for (auto& observer : observers) {
+      observer(value);
+    }
+  }
+
+  EventLoop* event_loop;
+  TriggeredEvent* notifier;
+  T value;
+  std::vector<observer_callback> observers;
+  uint32_t set_count = 0;
+  uint32_t notify_count = 0;
+};
+
+}  // namespace reactesp
+
+#endif  // REACTESP_SRC_OBSERVABLE_H_
@@ -0,0 +1,387 @@
+#ifndef REACTESP_SRC_OPERATORS_H_
+#define REACTESP_SRC_OPERATORS_H_
+
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+#include "event_loop.h"
+#include "events.h"
+
+namespace reactesp {
+
+/**
+ * @brief A stream of values pushed to subscribers
+ *
+ * Values are delivered synchronously to all subscribers when emit() is
+ * called. Operators subscribe to a source stream and are themselves
+ * streams, so they can be chained into pipelines that only do work when
+ * data arrives. A source must outlive the operators subscribed to it;
+ * operators unsubscribe when they are destroyed.
+ */
+template <typename T>
+class EventStream {
+ public:
+  using subscriber_callback = std::function<void(const T&)>;
+  using subscription_handle = uint32_t;
+
+  EventStream() = default;
+  virtual ~EventStream() = default;
+
+  EventStream(const EventStream&) = delete;
+  EventStream& operator=(const EventStream&) = delete;
+
+  /**
+   * @brief Add a subscriber
+   *
+   * A subscriber added during an emission receives the next value.
+   *
+   * @return subscription_handle Handle to pass to unsubscribe()
+   */
+  subscription_handle subscribe(subscriber_callback subscriber) {
+    const subscription_handle handle = ++last_handle;
+    if (emit_depth > 0) {
+      // growing the list could move the subscriber that is running
+      added.push_back({handle, subscriber});
+    } else {
+      subscribers.push_back({handle, subscriber});
+    }
+    return handle;
+  }
+
+  /**
+   * @brief Remove a subscriber
+   *
+   * Safe to call from within a subscriber, including the one removed.
+   */
+  void unsubscribe(subscription_handle handle) {
+    for (auto* list : {&subscribers, &added}) {
+      for (auto it = list->begin(); it != list->end(); ++it) {
+        if (it->handle == handle) {
+          if (emit_depth > 0) {
+            it->handle = 0;
+          } else {
+            list->erase(it);
+          }
+          return;
+        }
+      }
+    }
+  }
+
+  void emit(const T& value) {
+    emit_depth++;
+    for (size_t i = 0; i < subscribers.size(); i++) {
+      if (subscribers[i].handle != 0) {
+        subscribers[i].callback(value);
+      }
+    }
+    if (--emit_depth == 0) {
+      compact();
+    }
+  }
+
+ private:
+  struct Subscriber {
+    subscription_handle handle;
+    subscriber_callback callback;
+  };
+
+  // Apply the changes made during emissions
+  void compact() {
+    auto removed = [](const Subscriber& s) { return s.handle == 0; };
+    subscribers.erase(
+        std::remove_if(subscribers.begin(), subscribers.end(), removed),
+        subscribers.end());
+    for (auto& subscriber : added) {
+      if (subscriber.handle != 0) {
+        subscribers.push_back(subscriber);
+      }
+    }
+    added.clear();
+  }
+
+  std::vector<Subscriber> subscribers;
+  // subscribers added during an emission
+  std::vector<Subscriber> added;
+  subscription_handle last_handle = 0;
+  int emit_depth = 0;
+};
+
+/**
+ * @brief Interface for operators driven by a SharedTimers period
+ */
+class TimedOperator {
+ public:
+  virtual ~TimedOperator() = default;
+  virtual void onPeriod() = 0;
+};
+
+/**
+ * @brief Repeating timers shared by time-based operators
+ *
+ * All operators subscribed with the same period are driven by a single
+ * RepeatEvent, so adding time-based operators does not grow the timed
+ * event queue. Operators may subscribe and unsubscribe from within
+ * onPeriod().
+ */
+class SharedTimers {
+ public:
+  explicit SharedTimers(EventLoop* event_loop) : event_loop(event_loop) {}
+  ~SharedTimers() {
+    for (auto& timer : timers) {
+      timer.event->remove(event_loop);
+    }
+  }
+
+  SharedTimers(const SharedTimers&) = delete;
+  SharedTimers& operator=(const SharedTimers&) = delete;
+
+  /**
+   * @brief Call op->onPeriod() every period milliseconds
+   */
+  void subscribe(uint32_t period, TimedOperator* op) {
+    for (auto& timer : timers) {
+      if (timer.period == period) {
+        timer.operators.push_back(op);
+        return;
+      }
+    }
+    RepeatEvent* event = event_loop->onRepeat(
+        period, [this, period]() { this->dispatch(period); });
+    timers.push_back({period, event, std::vector<TimedOperator*>{op}});
+  }
+
+  void unsubscribe(TimedOperator* op) {
+    for (auto& timer : timers) {
+      std::replace(timer.operators.begin(), timer.operators.end(), op,
+                   static_cast<TimedOperator*>(nullptr));
+    }
+    // the lists are compacted once no dispatch is iterating over them
+    if (dispatching) {
+      compact_pending = true;
+    } else {
+      compact();
+    }
+  }
+
+  /**
+   * @brief Return the number of timers in use
+   */
+  size_t size() const { return timers.size(); }
+
+ private:
+  struct Timer {
+    uint32_t period;
+    RepeatEvent* event;
+    std::vector<TimedOperator*> operators;
+  };
+
+  void dispatch(uint32_t period) {
+    dispatching = true;
+    // Index instead of iterating: onPeriod() may subscribe new operators.
+    for (size_t t = 0; t < timers.size(); t++) {
+      if (timers[t].period != period) {
+        continue;
+      }
+      for (size_t i = 0; i < timers[t].operators.size(); i++) {
+        TimedOperator* op = timers[t].operators[i];
+        if (op != nullptr) {
+          op->onPeriod();
+        }
+      }
+      break;
+    }
+    dispatching = false;
+    if (compact_pending) {
+      compact_pending = false;
+      compact();
+    }
+  }
+
+  // Drop unsubscribed operators and the timers left without operators
+  void compact() {
+    for (auto it = timers.begin(); it != timers.end();) {
+      auto& ops = it->operators;
+      ops.erase(std::remove(ops.begin(), ops.end(), nullptr), ops.end());
+      if (ops.empty()) {
+        it->event->remove(event_loop);
+        it = timers.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+
+  EventLoop* event_loop;
+  std::vector<Timer> timers;
+  bool dispatching = false;
+  bool compact_pending = false;
+};
+
+/**
+ * @brief Emit the result of a function applied to each source value
+ */
+template <typename In, typename Out>
+class Map : public EventStream<Out> {
+ public:
+  Map(EventStream<In>& source, std::function<Out(const In&)> function)
+      : source(source), function(function) {
+    subscription = source.subscribe(
+        [this](const In& value) { this->emit(this->function(value)); });
+  }
+  ~Map() { source.unsubscribe(subscription); }
+
+ private:
+  EventStream<In>& source;
+  typename EventStream<In>::subscription_handle subscription;
+  std::function<Out(const In&)> function;
+};
+
+/**
+ * @brief Emit only the source values for which a predicate returns true
+ */
+template <typename T>
+class Filter : public EventStream<T> {
+ public:
+  Filter(EventStream<T>& source, std::function<bool(const T&)> predicate)
+      : source(source), predicate(predicate) {
+    subscription = source.subscribe([this](const T& value) {
+      if (this->predicate(value)) {
+        this->emit(value);
+      }
+    });
+  }
+  ~Filter() { source.unsubscribe(subscription); }
+
+ private:
+  EventStream<T>& source;
+  typename EventStream<T>::subscription_handle subscription;
+  std::function<bool(const T&)> predicate;
+};
+
+/**
+ * @brief Emit source values that differ from the previously emitted value
+ */
+template <typename T>
+class DistinctUntilChanged : public EventStream<T> {
+ public:
+  explicit DistinctUntilChanged(EventStream<T>& source) : source(source) {
+    subscription = source.subscribe([this](const T& value) {
+      if (!has_value || !(value == last)) {
+        has_value = true;
+        last = value;
+        this->emit(value);
+      }
+    });
+  }
+  ~DistinctUntilChanged() { source.unsubscribe(subscription); }
+
+ private:
+  EventStream<T>& source;
+  typename EventStream<T>::subscription_handle subscription;
+  bool has_value = false;
+  T last;
+};
+
+/**
+ * @brief Emit source values in groups of a fixed count
+ *
+ * The emitted vector is reused between emissions and is only valid during
+ * the subscriber call.
+ */
+template <typename T>
+class Buffer : public EventStream<std::vector<T>> {
+ public:
+  Buffer(EventStream<T>& source, size_t count) : source(source), count(count) {
+    items.reserve(count);
+    subscription = source.subscribe([this](const T& value) {
+      items.push_back(value);
+      if (items.size() >= this->count) {
+        this->emit(items);
+        items.clear();
+      }
+    });
+  }
+  ~Buffer() { source.unsubscribe(subscription); }
+
+ private:
+  EventStream<T>& source;
+  typename EventStream<T>::subscription_handle subscription;
+  const size_t count;
+  std::vector<T> items;
+};
+
+/**
+ * @brief Emit the source values received during each time window
+ *
+ * Empty windows are not emitted. The emitted vector is reused between
+ * emissions and is only valid during the subscriber call.
+ */
+template <typename T>
+class TimeWindow : public EventStream<std::vector<T>>, public TimedOperator {
+ public:
+  TimeWindow(SharedTimers& timers, EventStream<T>& source, uint32_t period)
+      : timers(timers), source(source) {
+    subscription =
+        source.subscribe([this](const T& value) { items.push_back(value); });
+    timers.subscribe(period, this);
+  }
+  ~TimeWindow() {
+    source.unsubscribe(subscription);
+    timers.unsubscribe(this);
+  }
+
+  void onPeriod() override {
+    if (!items.empty()) {
+      this->emit(items);
+      items.clear();
+    }
+  }
+
+ private:
+  SharedTimers& timers;
+  EventStream<T>& source;
+  typename EventStream<T>::subscription_handle subscription;
+  std::vector<T> items;
+};
+
+/**
+ * @brief Emit the latest source value once per period
+ *
+ * Nothing is emitted for periods without new source values.
+ */
+template <typename T>
+class Sample : public EventStream<T>, public TimedOperator {
+ public:
+  Sample(SharedTimers& timers, EventStream<T>& source, uint32_t period)
+      : timers(timers), source(source) {
+    subscription = source.subscribe([this](const T& value) {
+      latest = value;
+      has_value = true;
+    });
+    timers.subscribe(period, this);
+  }
+  ~Sample() {
+    source.unsubscribe(subscription);
+    timers.unsubscribe(this);
+  }
+
+  void onPeriod() override {
+    if (has_value) {
+      has_value = false;
+      this->emit(latest);
+    }
+  }
+
+ private:
+  SharedTimers& timers;
+  EventStream<T>& source;
+  typename EventStream<T>::subscription_handle subscription;
+  bool has_value = false;
+  T latest;
+};
+
+}  // namespace reactesp
+
+#endif  // REACTESP_SRC_OPERATORS_H_
@@ -0,0 +1,208 @@
+#ifndef REACTESP_SRC_SAMPLING_H_
+#define REACTESP_SRC_SAMPLING_H_
+
+#include <functional>
+#include <type_traits>
+#include <vector>
+
+#include "critical_section.h"
+#include "event_loop.h"
+#include "events.h"
+
+namespace reactesp {
+
+/**
+ * @brief Event that samples a value at a fixed rate and delivers the
+ *   samples in batches
+ *
+ * The sampler function is called by a PreciseRepeatEvent, from esp_timer
+ * on ESP32 and from the event loop elsewhere, and the samples are stored
+ * in a ring buffer of batches allocated at construction. Once a batch is
+ * full, the event is triggered and the consumer callback receives the whole
+ * batch in one call. Optionally, only every decimation'th sample is kept,
+ * or the average of decimation consecutive samples is stored.
+ *
+ * If the consumer falls behind and all batches are full, new samples are
+ * dropped and counted.
+ *
+ * On targets other than ESP32, PreciseRepeatEvent is a plain RepeatEvent,
+ * so every raw sample still costs a timed queue update and is taken no more
+ * precisely than the loop is ticked. The batching only saves the consumer
+ * callbacks there. For high sample rates on those targets, fill a Channel
+ * from a hardware timer interrupt and consume it with onReceive() instead.
+ */
+template <typename T>
+class SamplingEvent : public TriggeredEvent {
+ public:
+  using sampler_function = std::function<T()>;
+  using batch_callback = std::function<void(const T* samples, size_t count)>;
+
+  /**
+   * @brief Construct a new SamplingEvent object
+   *
+   * @param interval_us Sampling interval, in microseconds
+   * @param sampler Function returning one sample. Keep it short; on ESP32
+   *   it is called from the esp_timer task.
+   * @param batch_size Number of stored samples per consumer call
+   * @param callback Consumer callback, called from the event loop
+   * @param decimation Number of raw samples per stored sample
+   * @param average If true, store the average of the raw samples instead
+   *   of the first one. Only available for arithmetic types.
+   * @param num_batches Number of batches in the ring buffer; at least 2
+   */
+  SamplingEvent(uint64_t interval_us, sampler_function sampler,
+                size_t batch_size, batch_callback callback,
+                uint32_t decimation = 1, bool average = false,
+                size_t num_batches = 2)
+      : TriggeredEvent(nullptr),
+        interval_us(interval_us),
+        sampler(sampler),
+        consume(callback),
+        batch_size(batch_size > 0 ? batch_size : 1),
+        num_batches(num_batches > 2 ? num_batches : 2),
+        decimation(decimation > 0 ? decimation : 1),
+        average(average && std::is_arithmetic<T>::value),
+        buffer(this->batch_size * this->num_batches) {}
+
+  void add(EventLoop* event_loop) override {
+    TriggeredEvent::add(event_loop);
+    sample_timer = event_loop->onPreciseRepeatMicros(
+        interval_us, [this]() { this->sample(); });
+  }
+
+  void remove(EventLoop* event_loop) override {
+    if (sample_timer != nullptr) {
+      sample_timer->remove(event_loop);
+      sample_timer = nullptr;
+    }
+    TriggeredEvent::remove(event_loop);
+  }
+
+  void tick(EventLoop* event_loop) override {
+    lock.enter();
+    const size_t ready = ready_batches;
+    lock.exit();
+
+    for (size_t i = 0; i < ready; i++) {
+      consume(&buffer[read_batch * batch_size], batch_size);
+      read_batch = (read_batch + 1) % num_batches;
+    }
+
+    lock.enter();
+    ready_batches -= ready;
+    lock.exit();
+  }
+
+  using EventInterface::add;
+  using EventInterface::remove;
+  using EventInterface::tick;
+
+  /**
+   * @brief Take one raw sample
+   *
+   * Called by the sampling timer.
+   */
+  void sample() {
+    T value = sampler();
+    sample_count++;
+    if (decimation > 1) {
+      if (average) {
+        accumulate(value, std::is_arithmetic<T>());
+      }
+      if (++phase < decimation) {
+        if (phase == 1 && !average) {
+          first_value = value;
+        }
+        return;
+      }
+      phase = 0;
+      value = average ? mean(std::is_arithmetic<T>()) : first_value;
+    }
+    store(value);
+  }
+
+  /**
+   * @brief Return the number of raw samples taken
+   */
+  uint32_t getSampleCount() const { return sample_count; }
+  /**
+   * @brief Return the number of stored samples dropped because all batches
+   *   were full
+   */
+  uint32_t getDroppedCount() const { return dropped; }
+
+ private:
+  using sum_type = typename std::conditional<std::is_floating_point<T>::value,
+                                             double, int64_t>::type;
+
+  const uint64_t interval_us;
+  const sampler_function sampler;
+  const batch_callback consume;
+  const size_t batch_size;
+  const size_t num_batches;
+  const uint32_t decimation;
+  const bool average;
+  std::vector<T> buffer;
+  PreciseRepeatEvent* sample_timer = nullptr;
+  CriticalSection lock;
+
+  // producer state
+  size_t write_batch = 0;
+  size_t write_index = 0;
+  uint32_t phase = 0;
+  T first_value{};
+  sum_type sum = 0;
+  volatile uint32_t sample_count = 0;
+  volatile uint32_t dropped = 0;
+  // consumer state
+  size_t read_batch = 0;
+  // number of full batches, guarded by lock
+  size_t ready_batches = 0;
+
+  void accumulate(const T& value, std::true_type) { sum += value; }
+  void accumulate(const T& value, std::false_type) {}
+
+  T mean(std::true_type) {
+    const T value = static_cast<T>(sum / static_cast<sum_type>(decimation));
+    sum = 0;
+    return value;
+  }
+  T mean(std::false_type) { return first_value; }
+
+  void store(const T& value) {
+    if (write_index == 0) {
+      lock.enter();
+      const bool full = ready_batches == num_batches;
+      lock.exit();
+      if (full) {
+        dropped++;
+        return;
+      }
+    }
+    buffer[write_batch * batch_size + write_index] = value;
+    if (++write_index < batch_size) {
+      return;
+    }
+    write_index = 0;
+    write_batch = (write_batch + 1) % num_batches;
+    lock.enter();
+    ready_batches++;
+    lock.exit();
+    trigger();
+  }
+};
+
+template <typename T>
+SamplingEvent<T>* EventLoop::onSamplingMicros(
+    uint64_t interval_us, std::function<T()> sampler, size_t batch_size,
+    std::function<void(const T* samples, size_t count)> callback,
+    uint32_t decimation, bool average) {
+  auto* se = new SamplingEvent<T>(interval_us, sampler, batch_size, callback,
+                                  decimation, average);
+  se->add(this);
+  return se;
+}
+
+}  // namespace reactesp
+
+#endif  // REACTESP_SRC_SAMPLING_H_
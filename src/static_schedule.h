@@ -0,0 +1,194 @@
+#ifndef REACTESP_SRC_STATIC_SCHEDULE_H_
+#define REACTESP_SRC_STATIC_SCHEDULE_H_
+
+#include <Arduino.h>
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "event_loop.h"
+#include "events.h"
+
+namespace reactesp {
+
+/**
+ * @brief Periodic task of a static schedule
+ */
+struct StaticTask {
+  /// Repetition interval, in milliseconds
+  uint32_t interval;
+  /// Offset of the first run from the start of the schedule, in
+  /// milliseconds. Must be less than the interval.
+  uint32_t phase;
+  void (*function)();
+};
+
+namespace static_schedule_detail {
+
+template <size_t... I>
+struct IndexSequence {};
+
+template <typename A, typename B>
+struct ConcatSequence;
+
+template <size_t... I, size_t... J>
+struct ConcatSequence<IndexSequence<I...>, IndexSequence<J...>> {
+  using type = IndexSequence<I..., (sizeof...(I) + J)...>;
+};
+
+// Split in halves to keep the instantiation depth logarithmic
+template <size_t N>
+struct MakeIndexSequence {
+  using type = typename ConcatSequence<
+      typename MakeIndexSequence<N / 2>::type,
+      typename MakeIndexSequence<N - N / 2>::type>::type;
+};
+
+template <>
+struct MakeIndexSequence<0> {
+  using type = IndexSequence<>;
+};
+
+template <>
+struct MakeIndexSequence<1> {
+  using type = IndexSequence<0>;
+};
+
+constexpr uint32_t gcd(uint32_t a, uint32_t b) {
+  return b == 0 ? a : gcd(b, a % b);
+}
+
+// Least common multiple, saturating once it exceeds the uint32_t range
+constexpr uint64_t lcm(uint64_t a, uint32_t b) {
+  return a > UINT32_MAX ? a : a / gcd((uint32_t)a, b) * b;
+}
+
+template <size_t N>
+constexpr uint32_t basePeriod(const StaticTask (&tasks)[N], size_t i = 0) {
+  return i == N ? 0
+                : gcd(gcd(tasks[i].interval, tasks[i].phase),
+                      basePeriod(tasks, i + 1));
+}
+
+template <size_t N>
+constexpr uint64_t hyperperiod(const StaticTask (&tasks)[N], size_t i = 0) {
+  return i == N ? 1 : lcm(hyperperiod(tasks, i + 1), tasks[i].interval);
+}
+
+template <size_t N>
+constexpr bool valid(const StaticTask (&tasks)[N], size_t i = 0) {
+  return i == N || (tasks[i].interval > 0 &&
+                    tasks[i].phase < tasks[i].interval && valid(tasks, i + 1));
+}
+
+template <typename Schedule, typename Sequence>
+struct SlotTable;
+
+template <typename Schedule, size_t... S>
+struct SlotTable<Schedule, IndexSequence<S...>> {
+  static constexpr uint32_t masks[sizeof...(S)] PROGMEM = {
+      Schedule::slotMask(S)...};
+};
+
+template <typename Schedule, size_t... S>
+constexpr uint32_t
+    SlotTable<Schedule, IndexSequence<S...>>::masks[sizeof...(S)] PROGMEM;
+
+}  // namespace static_schedule_detail
+
+/**
+ * @brief Schedule of periodic tasks computed at compile time
+ *
+ * The task table is expanded by the compiler over the hyperperiod (the
+ * least common multiple of the intervals) into a table of slots, one per
+ * base period (the greatest common divisor of the intervals and phases).
+ * Each slot is a bitmask of the tasks due in it. The table is constant
+ * data in flash. Running the schedule takes a single repeating event: there
+ * is no per-task scheduling state in RAM, and the timed queue is updated
+ * once per base period instead of once per task run.
+ *
+ * Declare the tasks as a constexpr array at namespace scope and use the
+ * REACTESP_STATIC_SCHEDULE() macro to name the schedule type:
+ *
+ * @code
+ * constexpr StaticTask kTasks[] = {
+ *     {10, 0, read_sensors},
+ *     {20, 10, run_filter},
+ *     {1000, 0, publish},
+ * };
+ * using Schedule = REACTESP_STATIC_SCHEDULE(kTasks);
+ *
+ * event_loop.onStaticSchedule<Schedule>();
+ * @endcode
+ *
+ * @tparam N Number of tasks, at most 32
+ * @tparam Tasks Task table
+ */
+template <size_t N, const StaticTask (&Tasks)[N]>
+class StaticSchedule {
+ public:
+  static_assert(N > 0 && N <= 32, "a static schedule has 1 to 32 tasks");
+  static_assert(static_schedule_detail::valid(Tasks),
+                "task intervals must be non-zero and phases less than the "
+                "intervals");
+  static_assert(static_schedule_detail::hyperperiod(Tasks) <= UINT32_MAX,
+                "the hyperperiod of the task intervals overflows uint32_t");
+
+  /// Interval between two slots, in milliseconds
+  static constexpr uint32_t kBasePeriod =
+      static_schedule_detail::basePeriod(Tasks);
+  /// Length of the schedule before it repeats, in milliseconds
+  static constexpr uint32_t kHyperperiod =
+      (uint32_t)static_schedule_detail::hyperperiod(Tasks);
+  /// Number of slots in the hyperperiod
+  static constexpr uint32_t kSlots = kHyperperiod / kBasePeriod;
+
+  /**
+   * @brief Return the bitmask of tasks due in the given slot
+   */
+  static constexpr uint32_t slotMask(uint32_t slot, size_t i = 0) {
+    return i == N ? 0
+                  : (((uint64_t)slot * kBasePeriod) % Tasks[i].interval ==
+                             Tasks[i].phase
+                         ? (uint32_t)1 << i
+                         : 0) |
+                        slotMask(slot, i + 1);
+  }
+
+  /**
+   * @brief Run the tasks of a slot, in table order
+   */
+  static void dispatch(uint32_t slot) {
+    uint32_t mask = pgm_read_dword(&Table::masks[slot]);
+    while (mask != 0) {
+      const int i = __builtin_ctz(mask);
+      mask &= mask - 1;
+      Tasks[i].function();
+    }
+  }
+
+ private:
+  using Table = static_schedule_detail::SlotTable<
+      StaticSchedule,
+      typename static_schedule_detail::MakeIndexSequence<kSlots>::type>;
+};
+
+/**
+ * @brief Name the StaticSchedule type of a constexpr StaticTask array
+ */
+#define REACTESP_STATIC_SCHEDULE(tasks) \
+  ::reactesp::StaticSchedule<sizeof(tasks) / sizeof((tasks)[0]), tasks>
+
+template <typename Schedule>
+RepeatEvent* EventLoop::onStaticSchedule() {
+  uint32_t slot = 0;
+  // the first slot runs one base period from now
+  return onRepeat(Schedule::kBasePeriod, [slot]() mutable {
+    Schedule::dispatch(slot);
+    slot = slot + 1 == Schedule::kSlots ? 0 : slot + 1;
+  });
+}
+
+}  // namespace reactesp
+
+#endif  // REACTESP_SRC_STATIC_SCHEDULE_H_
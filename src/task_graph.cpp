@@ -0,0 +1,172 @@
+#include "task_graph.h"
+
+namespace reactesp {
+
+int TaskGraph::addNode(react_callback callback, bool async) {
+  if (built || nodes.size() >= UINT16_MAX) {
+    return -1;
+  }
+  Node node = {};
+  node.callback = callback;
+  node.async = async;
+  nodes.push_back(node);
+  return nodes.size() - 1;
+}
+
+bool TaskGraph::addDependency(int node, int depends_on) {
+  const int n = nodes.size();
+  if (built || node < 0 || node >= n || depends_on < 0 || depends_on >= n) {
+    return false;
+  }
+  edges.push_back({(uint16_t)node, (uint16_t)depends_on});
+  return true;
+}
+
+bool TaskGraph::build() {
+  if (built) {
+    return true;
+  }
+  const size_t n = nodes.size();
+
+  // store the successor lists in compressed form
+  successor_start.assign(n + 1, 0);
+  for (Node& node : nodes) {
+    node.in_degree = 0;
+  }
+  for (const auto& edge : edges) {
+    successor_start[edge.second + 1]++;
+    nodes[edge.first].in_degree++;
+  }
+  for (size_t i = 0; i < n; i++) {
+    successor_start[i + 1] += successor_start[i];
+  }
+  successors.resize(edges.size());
+  std::vector<uint32_t> fill(successor_start.begin(),
+                             successor_start.end() - 1);
+  for (const auto& edge : edges) {
+    successors[fill[edge.second]++] = edge.first;
+  }
+
+  // Kahn's algorithm: the graph is acyclic if all nodes can be removed in
+  // dependency order
+  ready.resize(n);
+  size_t read = 0;
+  size_t write = 0;
+  for (size_t i = 0; i < n; i++) {
+    nodes[i].remaining = nodes[i].in_degree;
+    if (nodes[i].remaining == 0) {
+      ready[write++] = i;
+    }
+  }
+  while (read < write) {
+    const uint16_t node = ready[read++];
+    for (uint32_t i = successor_start[node]; i < successor_start[node + 1];
+         i++) {
+      if (--nodes[successors[i]].remaining == 0) {
+        ready[write++] = successors[i];
+      }
+    }
+  }
+  if (write != n) {
+    return false;
+  }
+
+  edges.clear();
+  edges.shrink_to_fit();
+  built = true;
+  return true;
+}
+
+bool TaskGraph::run() {
+  if (!built || running) {
+    return false;
+  }
+  running = true;
+  completed = 0;
+  ready_read = 0;
+  ready_write = 0;
+  run_start = micros64();
+  for (size_t i = 0; i < nodes.size(); i++) {
+    Node& node = nodes[i];
+    node.started = false;
+    node.remaining = node.in_degree;
+    if (node.remaining == 0) {
+      ready[ready_write++] = i;
+    }
+  }
+  runner->trigger();
+  return true;
+}
+
+void TaskGraph::runReady() {
+  if (running && nodes.empty()) {
+    // an empty graph completes on the first tick
+    running = false;
+    run_count++;
+    last_run_duration = 0;
+    if (complete_cb) {
+      complete_cb();
+    }
+    return;
+  }
+  // run the nodes that are ready now; nodes that become ready meanwhile
+  // run on the next tick, letting other events run in between
+  const size_t end = ready_write;
+  const uint32_t execution = run_count;
+  while (ready_read < end) {
+    const uint16_t id = ready[ready_read++];
+    Node& node = nodes[id];
+    node.started = true;
+    node.start_time = micros64();
+    node.callback();
+    if (!node.async) {
+      finish(id);
+    }
+    if (run_count != execution) {
+      // The execution has completed. If the completion callback restarted
+      // the graph, the new execution starts on the next tick.
+      return;
+    }
+  }
+}
+
+bool TaskGraph::complete(int node) {
+  if (!running || node < 0 || node >= (int)nodes.size() ||
+      !nodes[node].async || !nodes[node].started) {
+    return false;
+  }
+  nodes[node].started = false;
+  finish(node);
+  return true;
+}
+
+void TaskGraph::finish(uint16_t id) {
+  Node& node = nodes[id];
+  const uint64_t duration = micros64() - node.start_time;
+  const uint32_t duration32 =
+      duration > UINT32_MAX ? UINT32_MAX : (uint32_t)duration;
+  node.stats.runs++;
+  node.stats.last_duration = duration32;
+  node.stats.total_duration += duration;
+  if (duration32 > node.stats.max_duration) {
+    node.stats.max_duration = duration32;
+  }
+
+  for (uint32_t i = successor_start[id]; i < successor_start[id + 1]; i++) {
+    if (--nodes[successors[i]].remaining == 0) {
+      ready[ready_write++] = successors[i];
+      runner->trigger();
+    }
+  }
+
+  if (++completed == nodes.size()) {
+    running = false;
+    run_count++;
+    last_run_duration = micros64() - run_start;
+    if (complete_cb) {
+      complete_cb();
+    }
+  }
+}
+
+}  // namespace reactesp
@@ -0,0 +1,158 @@
+#ifndef REACTESP_SRC_TASK_GRAPH_H_
+#define REACTESP_SRC_TASK_GRAPH_H_
+
+#include <functional>
+#include <vector>
+
+#include "event_loop.h"
+#include "events.h"
+
+namespace reactesp {
+
+/**
+ * @brief Execution statistics of a task graph node
+ */
+struct TaskNodeStats {
+  /// Number of completed runs
+  uint32_t runs = 0;
+  /// Duration of the last run, in microseconds
+  uint32_t last_duration = 0;
+  /// Maximum run duration, in microseconds
+  uint32_t max_duration = 0;
+  /// Total time spent in the node, in microseconds
+  uint64_t total_duration = 0;
+};
+
+/**
+ * @brief Graph of tasks with dependencies, run by the event loop
+ *
+ * Nodes are added with addNode() and dependencies with addDependency().
+ * build() then stores the edges in compressed form (one index array for
+ * all successor lists), checks that the graph has no cycles and allocates
+ * all the state needed for running it. After that, run() starts an
+ * execution: every node is run by the event loop as soon as all the nodes
+ * it depends on have completed, and running the graph does not allocate.
+ *
+ * A node normally completes when its callback returns. A node added as
+ * asynchronous completes only when complete() is called for it, for
+ * example from the callback of a sensor read it started.
+ */
+class TaskGraph {
+ public:
+  TaskGraph(EventLoop* event_loop) : event_loop(event_loop) {
+    runner = event_loop->onTrigger([this]() { runReady(); });
+  }
+  ~TaskGraph() { runner->remove(event_loop); }
+
+  TaskGraph(const TaskGraph&) = delete;
+  TaskGraph& operator=(const TaskGraph&) = delete;
+
+  /**
+   * @brief Add a node to the graph
+   *
+   * @param callback Task function
+   * @param async If true, the node completes when complete() is called
+   *   instead of when the callback returns
+   * @return Node id, or -1 if the graph has already been built
+   */
+  int addNode(react_callback callback, bool async = false);
+
+  /**
+   * @brief Make a node wait for the completion of another node
+   *
+   * @return false if either node id is invalid or the graph has already
+   *   been built
+   */
+  bool addDependency(int node, int depends_on);
+
+  /**
+   * @brief Finalize the graph
+   *
+   * @return false if the dependencies contain a cycle. The graph cannot be
+   *   run in that case.
+   */
+  bool build();
+  bool isBuilt() const { return built; }
+
+  /**
+   * @brief Start an execution of the graph
+   *
+   * Can be called from the completion callback; the new execution then
+   * starts on the next tick.
+   *
+   * @return false if the graph has not been built or is already running
+   */
+  bool run();
+  bool isRunning() const { return running; }
+
+  /**
+   * @brief Complete an asynchronous node
+   *
+   * Must be called from the event loop task.
+   *
+   * @return false if the node is not an asynchronous node that is running
+   */
+  bool complete(int node);
+
+  /**
+   * @brief Set a function called when all nodes of an execution have
+   *   completed
+   */
+  void onComplete(react_callback callback) { complete_cb = callback; }
+
+  size_t size() const { return nodes.size(); }
+  const TaskNodeStats& getNodeStats(int node) const {
+    return nodes[node].stats;
+  }
+  uint32_t getRunCount() const { return run_count; }
+  /**
+   * @brief Return the duration of the last complete execution, in
+   *   microseconds
+   */
+  uint32_t getLastRunDuration() const { return last_run_duration; }
+
+ protected:
+  struct Node {
+    react_callback callback;
+    bool async;
+    bool started;
+    uint32_t in_degree;
+    // dependencies not completed yet in the current execution
+    uint32_t remaining;
+    uint64_t start_time;
+    TaskNodeStats stats;
+  };
+
+  EventLoop* event_loop;
+  TriggeredEvent* runner;
+  react_callback complete_cb;
+
+  std::vector<Node> nodes;
+  // Dependencies as (node, depends_on) pairs, until the graph is built
+  std::vector<std::pair<uint16_t, uint16_t>> edges;
+  // Successor lists: the successors of node i are
+  // successors[successor_start[i]] ... successors[successor_start[i + 1] - 1]
+  // The offsets are 32-bit, as the number of edges is not limited by the
+  // 16-bit node ids.
+  std::vector<uint32_t> successor_start;
+  std::vector<uint16_t> successors;
+  // Nodes whose dependencies have completed, in the order they became
+  // ready. Each node is appended once per execution.
+  std::vector<uint16_t> ready;
+  size_t ready_read = 0;
+  size_t ready_write = 0;
+
+  bool built = false;
+  bool running = false;
+  size_t completed = 0;
+  uint64_t run_start = 0;
+  uint32_t run_count = 0;
+  uint32_t last_run_duration = 0;
+
+  void runReady();
+  void finish(uint16_t node);
+};
+
+}  // namespace reactesp
+
+#endif  // REACTESP_SRC_TASK_GRAPH_H_
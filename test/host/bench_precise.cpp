@@ -0,0 +1,74 @@
+// Trigger accuracy of a repeating event run by tickBlocking(), with and
+// without the early-wake-and-spin precision mode. The clock is simulated:
+// every clock read takes 1 us, and waking up from a blocking wait is late
+// by a varying jitter. In the busy scenario, an untimed event takes
+// 300 us on every tick, so the precise event also has to get ahead of it.
+
+#include "ReactESP.h"
+#include "host.h"
+
+using namespace reactesp;
+
+namespace {
+
+const uint32_t kIntervalMs = 5;
+const int kRepeats = 1000;
+const int64_t kMaxJitterUs = 1500;
+const uint64_t kWorkUs = 300;
+
+void busyWait(uint64_t us) {
+  const uint64_t end = micros64() + us;
+  while (micros64() < end) {
+  }
+}
+
+struct Result {
+  LatenessStats lateness;
+  uint32_t margin_us;
+};
+
+Result run(bool precise, bool busy) {
+  host::useManualClock(1000000);
+  host::setAutoAdvance(1);
+  EventLoop loop;
+  uint32_t seed = 1;
+  int repeats = 0;
+  RepeatEvent* event = loop.onRepeat(kIntervalMs, [&]() {
+    repeats++;
+    seed = seed * 1103515245 + 12345;
+    host::setWakeJitter((seed >> 16) % kMaxJitterUs);
+  });
+  event->setPrecise(precise);
+  if (busy) {
+    loop.onTick([]() { busyWait(kWorkUs); });
+  }
+  // let the margin settle before measuring
+  while (repeats < 50) {
+    loop.tickBlocking();
+  }
+  loop.resetLatenessStats();
+  while (repeats < 50 + kRepeats) {
+    loop.tickBlocking();
+  }
+  return {loop.getLatenessStats(), loop.getEarlyWakeMargin()};
+}
+
+void report(const char* name, const Result& result) {
+  printf("%-18s lateness mean %4llu us  max %4llu us  margin %4u us\n", name,
+         (unsigned long long)result.lateness.getAverage(),
+         (unsigned long long)result.lateness.max, result.margin_us);
+}
+
+}  // namespace
+
+int main() {
+  printf("%d repeats every %u ms, wake jitter up to %lld us\n", kRepeats,
+         kIntervalMs, (long long)kMaxJitterUs);
+  report("idle, regular", run(false, false));
+  report("idle, precise", run(true, false));
+  printf("with %llu us of untimed work per tick\n",
+         (unsigned long long)kWorkUs);
+  report("busy, regular", run(false, true));
+  report("busy, precise", run(true, true));
+  return 0;
+}
@@ -0,0 +1,108 @@
+// Compare polling FreeRTOS queues from an onTick() handler in a busy loop
+// with QueueEvents in a blocking loop. A producer thread sends timestamps
+// to a set of queues; the loop thread CPU time, the number of ticks and
+// the send-to-callback latency are reported for both.
+
+#include <freertos/queue.h>
+#include <time.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "ReactESP.h"
+#include "host.h"
+
+using namespace reactesp;
+
+namespace {
+
+const int kQueues = 6;
+const int kItems = 500;
+const int kSendIntervalUs = 1000;
+
+int64_t threadCpuMicros() {
+  timespec ts;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+struct Result {
+  int64_t cpu_us;
+  uint64_t ticks;
+  int64_t total_latency_us;
+  int64_t max_latency_us;
+};
+
+void produce(const std::vector<QueueHandle_t>& queues) {
+  for (int i = 0; i < kItems; i++) {
+    std::this_thread::sleep_for(std::chrono::microseconds(kSendIntervalUs));
+    const int64_t now = esp_timer_get_time();
+    xQueueSend(queues[i % kQueues], &now, portMAX_DELAY);
+  }
+}
+
+Result run(bool blocking) {
+  EventLoop loop;
+  std::vector<QueueHandle_t> queues;
+  for (int i = 0; i < kQueues; i++) {
+    queues.push_back(xQueueCreate(4, sizeof(int64_t)));
+  }
+  Result result = {0, 0, 0, 0};
+  int received = 0;
+  auto receive = [&](QueueHandle_t queue) {
+    int64_t sent;
+    while (xQueueReceive(queue, &sent, 0) == pdTRUE) {
+      const int64_t latency = esp_timer_get_time() - sent;
+      result.total_latency_us += latency;
+      result.max_latency_us = std::max(result.max_latency_us, latency);
+      received++;
+    }
+  };
+  if (blocking) {
+    for (QueueHandle_t queue : queues) {
+      loop.onQueue(queue, [queue, &receive]() { receive(queue); });
+    }
+  } else {
+    loop.onTick([&]() {
+      for (QueueHandle_t queue : queues) {
+        if (uxQueueMessagesWaiting(queue) > 0) {
+          receive(queue);
+        }
+      }
+    });
+  }
+
+  std::thread producer(produce, std::cref(queues));
+  const int64_t cpu_start = threadCpuMicros();
+  while (received < kItems) {
+    if (blocking) {
+      loop.tickBlocking();
+    } else {
+      loop.tick();
+    }
+  }
+  result.cpu_us = threadCpuMicros() - cpu_start;
+  result.ticks = loop.getTickCount();
+  producer.join();
+  return result;
+}
+
+void report(const char* name, const Result& result) {
+  printf("%-20s cpu %7lld us  ticks %8llu  latency mean %4lld us"
+         "  max %5lld us\n",
+         name, (long long)result.cpu_us, (unsigned long long)result.ticks,
+         (long long)(result.total_latency_us / kItems),
+         (long long)result.max_latency_us);
+}
+
+}  // namespace
+
+int main() {
+  printf("%d items to %d queues, one every %d us\n", kItems, kQueues,
+         kSendIntervalUs);
+  report("onTick() polling", run(false));
+  report("onQueue() blocking", run(true));
+  return 0;
+}
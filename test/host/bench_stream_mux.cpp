@@ -0,0 +1,113 @@
+// Cost per tick of monitoring mostly idle streams with one StreamEvent
+// per stream versus a single StreamMuxEvent, and the added latency of the
+// mux for the first byte after an idle period.
+
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include "ReactESP.h"
+#include "fake_stream.h"
+#include "host.h"
+
+using namespace reactesp;
+
+namespace {
+
+const int kTicks = 200000;
+const uint16_t kMaxBackoff = 16;
+
+struct Result {
+  double ns_per_tick;
+  double available_per_tick;
+};
+
+Result run(int stream_count, bool mux) {
+  EventLoop loop;
+  std::vector<std::unique_ptr<FakeStream>> streams;
+  uint64_t bytes = 0;
+  StreamMuxEvent* mux_event = mux ? loop.onAvailableMux(kMaxBackoff) : nullptr;
+  for (int i = 0; i < stream_count; i++) {
+    streams.emplace_back(new FakeStream());
+    FakeStream* stream = streams.back().get();
+    auto callback = [stream, &bytes]() {
+      while (stream->read() >= 0) {
+        bytes++;
+      }
+    };
+    if (mux) {
+      mux_event->addStream(*stream, callback);
+    } else {
+      loop.onAvailable(*stream, callback);
+    }
+  }
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < kTicks; i++) {
+    // one stream receives a byte every 100 ticks; the others stay idle
+    if (i % 100 == 0) {
+      streams[0]->put(1);
+    }
+    loop.tick();
+  }
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+  uint64_t calls = 0;
+  for (auto& stream : streams) {
+    calls += stream->available_calls;
+  }
+  return {std::chrono::duration<double, std::nano>(elapsed).count() / kTicks,
+          (double)calls / kTicks};
+}
+
+// ticks from the arrival of a byte on an idle stream to its callback
+int firstByteLatency(int idle_ticks) {
+  EventLoop loop;
+  FakeStream stream;
+  bool seen = false;
+  loop.onAvailableMux(kMaxBackoff)->addStream(stream, [&]() {
+    stream.read();
+    seen = true;
+  });
+  for (int i = 0; i < idle_ticks; i++) {
+    loop.tick();
+  }
+  stream.put(1);
+  int ticks = 0;
+  while (!seen) {
+    loop.tick();
+    ticks++;
+  }
+  return ticks;
+}
+
+}  // namespace
+
+int main() {
+  printf("%7s  %24s  %24s\n", "streams", "StreamEvent per stream",
+         "StreamMuxEvent");
+  printf("%7s  %11s %12s  %11s %12s\n", "", "ns/tick", "available()",
+         "ns/tick", "available()");
+  Result polled_one = {0, 0};
+  Result mux_one = {0, 0};
+  Result polled = {0, 0};
+  Result mux = {0, 0};
+  for (int count : {1, 2, 4, 8, 16, 32}) {
+    polled = run(count, false);
+    mux = run(count, true);
+    if (count == 1) {
+      polled_one = polled;
+      mux_one = mux;
+    }
+    printf("%7d  %11.1f %12.2f  %11.1f %12.2f\n", count, polled.ns_per_tick,
+           polled.available_per_tick, mux.ns_per_tick,
+           mux.available_per_tick);
+  }
+  printf("\ncost per idle stream per tick: %.2f ns polled, %.2f ns mux\n",
+         (polled.ns_per_tick - polled_one.ns_per_tick) / 31,
+         (mux.ns_per_tick - mux_one.ns_per_tick) / 31);
+  printf("\nmux first-byte latency after an idle period (max backoff %u):\n",
+         kMaxBackoff);
+  for (int idle : {0, 10, 100, 1000}) {
+    printf("  idle %4d ticks: %d ticks\n", idle, firstByteLatency(idle));
+  }
+  return 0;
+}
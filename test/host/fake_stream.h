@@ -0,0 +1,35 @@
+#ifndef REACTESP_TEST_HOST_FAKE_STREAM_H_
+#define REACTESP_TEST_HOST_FAKE_STREAM_H_
+
+#include <Arduino.h>
+
+#include <atomic>
+
+/**
+ * @brief Stream with a byte counter as its receive buffer
+ *
+ * put() may be called from another thread, as by a driver task.
+ */
+class FakeStream : public Stream {
+ public:
+  int available() override {
+    available_calls++;
+    return pending.load();
+  }
+  int read() override {
+    int count = pending.load();
+    while (count > 0 && !pending.compare_exchange_weak(count, count - 1)) {
+    }
+    return count > 0 ? 'x' : -1;
+  }
+  int peek() override { return pending.load() > 0 ? 'x' : -1; }
+  size_t write(uint8_t c) override { return 1; }
+  int availableForWrite() override { return 64; }
+
+  void put(int count) { pending += count; }
+
+  std::atomic<int> pending{0};
+  uint64_t available_calls = 0;
+};
+
+#endif  // REACTESP_TEST_HOST_FAKE_STREAM_H_
@@ -0,0 +1,30 @@
+#ifndef REACTESP_TEST_HOST_HOST_TEST_H_
+#define REACTESP_TEST_HOST_HOST_TEST_H_
+
+// Minimal checks for the host tests. Unlike assert(), they are not
+// compiled out with NDEBUG.
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define CHECK(cond)                                                    \
+  do {                                                                 \
+    if (!(cond)) {                                                     \
+      fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, \
+              #cond);                                                  \
+      exit(1);                                                         \
+    }                                                                  \
+  } while (0)
+
+#define CHECK_EQ(a, b)                                                     \
+  do {                                                                     \
+    const long long check_a_ = (long long)(a);                             \
+    const long long check_b_ = (long long)(b);                             \
+    if (check_a_ != check_b_) {                                            \
+      fprintf(stderr, "%s:%d: check failed: %s == %s (%lld != %lld)\n",    \
+              __FILE__, __LINE__, #a, #b, check_a_, check_b_);             \
+      exit(1);                                                             \
+    }                                                                      \
+  } while (0)
+
+#endif  // REACTESP_TEST_HOST_HOST_TEST_H_
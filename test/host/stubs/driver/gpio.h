@@ -0,0 +1,38 @@
+#ifndef REACTESP_TEST_HOST_STUBS_DRIVER_GPIO_H_
+#define REACTESP_TEST_HOST_STUBS_DRIVER_GPIO_H_
+
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "esp_intr_alloc.h"
+#include "soc/gpio_struct.h"
+
+#define GPIO_PIN_COUNT 40
+
+typedef int gpio_num_t;
+typedef enum {
+  GPIO_INTR_DISABLE,
+  GPIO_INTR_POSEDGE,
+  GPIO_INTR_NEGEDGE,
+  GPIO_INTR_ANYEDGE,
+} gpio_int_type_t;
+
+typedef void (*gpio_isr_t)(void* arg);
+typedef intr_handle_t gpio_isr_handle_t;
+
+esp_err_t gpio_set_intr_type(gpio_num_t gpio_num, gpio_int_type_t intr_type);
+esp_err_t gpio_intr_enable(gpio_num_t gpio_num);
+esp_err_t gpio_intr_disable(gpio_num_t gpio_num);
+int gpio_get_level(gpio_num_t gpio_num);
+
+// The ISR service and gpio_isr_register() both allocate the single GPIO
+// interrupt; only one of them can be used at a time.
+esp_err_t gpio_install_isr_service(int intr_alloc_flags);
+void gpio_uninstall_isr_service();
+esp_err_t gpio_isr_handler_add(gpio_num_t gpio_num, gpio_isr_t isr_handler,
+                               void* args);
+esp_err_t gpio_isr_handler_remove(gpio_num_t gpio_num);
+esp_err_t gpio_isr_register(void (*fn)(void*), void* arg, int intr_alloc_flags,
+                            gpio_isr_handle_t* handle);
+
+#endif  // REACTESP_TEST_HOST_STUBS_DRIVER_GPIO_H_
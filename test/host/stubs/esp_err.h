@@ -0,0 +1,13 @@
+#ifndef REACTESP_TEST_HOST_STUBS_ESP_ERR_H_
+#define REACTESP_TEST_HOST_STUBS_ESP_ERR_H_
+
+typedef int esp_err_t;
+
+#define ESP_OK 0
+#define ESP_FAIL -1
+#define ESP_ERR_NO_MEM 0x101
+#define ESP_ERR_INVALID_ARG 0x102
+#define ESP_ERR_INVALID_STATE 0x103
+#define ESP_ERR_NOT_FOUND 0x105
+
+#endif  // REACTESP_TEST_HOST_STUBS_ESP_ERR_H_
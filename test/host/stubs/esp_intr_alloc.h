@@ -0,0 +1,18 @@
+#ifndef REACTESP_TEST_HOST_STUBS_ESP_INTR_ALLOC_H_
+#define REACTESP_TEST_HOST_STUBS_ESP_INTR_ALLOC_H_
+
+#include "esp_err.h"
+
+#define ESP_INTR_FLAG_LEVEL1 (1 << 1)
+#define ESP_INTR_FLAG_LEVEL2 (1 << 2)
+#define ESP_INTR_FLAG_LEVEL3 (1 << 3)
+#define ESP_INTR_FLAG_SHARED (1 << 8)
+#define ESP_INTR_FLAG_IRAM (1 << 10)
+#define ESP_INTR_FLAG_LOWMED \
+  (ESP_INTR_FLAG_LEVEL1 | ESP_INTR_FLAG_LEVEL2 | ESP_INTR_FLAG_LEVEL3)
+
+typedef struct intr_handle_data_t* intr_handle_t;
+
+esp_err_t esp_intr_free(intr_handle_t handle);
+
+#endif  // REACTESP_TEST_HOST_STUBS_ESP_INTR_ALLOC_H_
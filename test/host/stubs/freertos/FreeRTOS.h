@@ -0,0 +1,63 @@
+#ifndef REACTESP_TEST_HOST_STUBS_FREERTOS_FREERTOS_H_
+#define REACTESP_TEST_HOST_STUBS_FREERTOS_FREERTOS_H_
+
+// Host stand-in for the parts of FreeRTOS used by the library. Queues,
+// semaphores, mutexes and queue sets block for real on a condition
+// variable; see host.cpp.
+
+#include <stdint.h>
+
+struct QueueDefinition;
+struct EventGroupDef_t;
+struct tskTaskControlBlock;
+
+typedef QueueDefinition* QueueHandle_t;
+typedef QueueDefinition* SemaphoreHandle_t;
+typedef QueueDefinition* QueueSetHandle_t;
+typedef QueueDefinition* QueueSetMemberHandle_t;
+typedef EventGroupDef_t* EventGroupHandle_t;
+typedef tskTaskControlBlock* TaskHandle_t;
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t EventBits_t;
+
+#define portMAX_DELAY ((TickType_t)0xffffffffUL)
+#define portTICK_PERIOD_MS 1
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms) / portTICK_PERIOD_MS)
+#define pdFALSE 0
+#define pdTRUE 1
+#define pdFAIL 0
+#define pdPASS 1
+
+typedef struct {
+  int owner;
+  int count;
+} portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED \
+  { 0, 0 }
+
+// Critical sections and interrupt handlers are serialized by a single
+// recursive lock, as interrupts and critical sections are on one core.
+void vPortEnterCritical(portMUX_TYPE* mux);
+void vPortExitCritical(portMUX_TYPE* mux);
+#define portENTER_CRITICAL(mux) vPortEnterCritical(mux)
+#define portEXIT_CRITICAL(mux) vPortExitCritical(mux)
+#define portENTER_CRITICAL_ISR(mux) vPortEnterCritical(mux)
+#define portEXIT_CRITICAL_ISR(mux) vPortExitCritical(mux)
+#define portENTER_CRITICAL_SAFE(mux) vPortEnterCritical(mux)
+#define portEXIT_CRITICAL_SAFE(mux) vPortExitCritical(mux)
+
+BaseType_t xPortInIsrContext();
+#define portYIELD_FROM_ISR() \
+  do {                       \
+  } while (0)
+
+#define configASSERT(x)                                   \
+  do {                                                    \
+    if (!(x)) host_assert_failed(#x, __FILE__, __LINE__); \
+  } while (0)
+void host_assert_failed(const char* expr, const char* file, int line);
+
+#endif  // REACTESP_TEST_HOST_STUBS_FREERTOS_FREERTOS_H_
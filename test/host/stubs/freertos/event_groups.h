@@ -0,0 +1,12 @@
+#ifndef REACTESP_TEST_HOST_STUBS_FREERTOS_EVENT_GROUPS_H_
+#define REACTESP_TEST_HOST_STUBS_FREERTOS_EVENT_GROUPS_H_
+
+#include "freertos/FreeRTOS.h"
+
+EventGroupHandle_t xEventGroupCreate();
+void vEventGroupDelete(EventGroupHandle_t group);
+EventBits_t xEventGroupSetBits(EventGroupHandle_t group, EventBits_t bits);
+EventBits_t xEventGroupClearBits(EventGroupHandle_t group, EventBits_t bits);
+EventBits_t xEventGroupGetBits(EventGroupHandle_t group);
+
+#endif  // REACTESP_TEST_HOST_STUBS_FREERTOS_EVENT_GROUPS_H_
@@ -0,0 +1,10 @@
+#ifndef REACTESP_TEST_HOST_STUBS_FREERTOS_TASK_H_
+#define REACTESP_TEST_HOST_STUBS_FREERTOS_TASK_H_
+
+#include "freertos/FreeRTOS.h"
+
+// Every host thread is a task.
+TaskHandle_t xTaskGetCurrentTaskHandle();
+void vTaskDelay(TickType_t ticks);
+
+#endif  // REACTESP_TEST_HOST_STUBS_FREERTOS_TASK_H_
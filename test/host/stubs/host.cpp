@@ -0,0 +1,822 @@
+// Host stand-ins for the Arduino core, FreeRTOS and the ESP-IDF drivers
+// used by the library. Nothing here allocates after an object has been
+// created, so the stand-ins can be used under the allocation check.
+
+#include "host.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Arduino.h"
+#include "driver/gpio.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+namespace {
+
+//////////////////////////////////////////////////////////////////////////
+// Clock
+
+std::atomic<bool> manual_clock(false);
+std::atomic<int64_t> manual_now(0);
+std::atomic<int64_t> auto_advance(0);
+std::atomic<int64_t> wake_jitter(0);
+
+std::chrono::steady_clock::time_point epoch() {
+  static const auto start = std::chrono::steady_clock::now();
+  return start;
+}
+
+int64_t realNow() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now() - epoch())
+      .count();
+}
+
+// The current time without the auto-advance step, for the stand-ins
+int64_t peekNow() {
+  return manual_clock.load() ? manual_now.load() : realNow();
+}
+
+void notifyClockChange();
+
+//////////////////////////////////////////////////////////////////////////
+// Interrupts and critical sections
+
+std::recursive_mutex& interruptLock() {
+  static std::recursive_mutex lock;
+  return lock;
+}
+
+thread_local int isr_depth = 0;
+thread_local uint32_t ps_level = 0;
+
+//////////////////////////////////////////////////////////////////////////
+// FreeRTOS objects share one lock and one condition variable
+
+std::mutex& rtosMutex() {
+  static std::mutex mutex;
+  return mutex;
+}
+
+std::condition_variable& rtosCondition() {
+  static std::condition_variable condition;
+  return condition;
+}
+
+// Wait until pred() holds or the timeout expires. In manual clock mode, a
+// timeout moves the clock to the deadline instead of waiting.
+template <typename Pred>
+bool waitFor(std::unique_lock<std::mutex>& lock, TickType_t ticks,
+             Pred pred) {
+  if (pred()) {
+    return true;
+  }
+  if (ticks == 0) {
+    return false;
+  }
+  if (ticks == portMAX_DELAY) {
+    rtosCondition().wait(lock, pred);
+    return true;
+  }
+  const int64_t timeout_us = (int64_t)ticks * 1000 * portTICK_PERIOD_MS;
+  if (manual_clock.load()) {
+    const int64_t now = manual_now.load();
+    const int64_t tick_us = 1000 * portTICK_PERIOD_MS;
+    // wake up on a tick boundary, like the tick interrupt
+    manual_now.store(now - now % tick_us + timeout_us + wake_jitter.load());
+    notifyClockChange();
+    return pred();
+  }
+  return rtosCondition().wait_for(
+      lock, std::chrono::microseconds(timeout_us), pred);
+}
+
+}  // namespace
+
+//////////////////////////////////////////////////////////////////////////
+// FreeRTOS
+
+struct QueueDefinition {
+  enum Type { kQueue, kSet, kSemaphore, kRecursiveMutex } type;
+  UBaseType_t length;
+  UBaseType_t item_size;
+  uint8_t* storage;
+  UBaseType_t head;
+  UBaseType_t count;
+  QueueDefinition* set;
+  TaskHandle_t owner;
+  UBaseType_t depth;
+};
+
+struct EventGroupDef_t {
+  std::atomic<EventBits_t> bits;
+};
+
+namespace {
+
+QueueDefinition* createQueue(QueueDefinition::Type type, UBaseType_t length,
+                             UBaseType_t item_size) {
+  auto* queue = new QueueDefinition();
+  queue->type = type;
+  queue->length = length;
+  queue->item_size = item_size;
+  queue->storage = item_size == 0 ? nullptr : new uint8_t[length * item_size];
+  queue->head = 0;
+  queue->count = 0;
+  queue->set = nullptr;
+  queue->owner = nullptr;
+  queue->depth = 0;
+  return queue;
+}
+
+void pushItem(QueueDefinition* queue, const void* item) {
+  const UBaseType_t tail = (queue->head + queue->count) % queue->length;
+  if (queue->item_size != 0) {
+    memcpy(queue->storage + tail * queue->item_size, item, queue->item_size);
+  }
+  queue->count++;
+}
+
+void popItem(QueueDefinition* queue, void* item) {
+  if (queue->item_size != 0 && item != nullptr) {
+    memcpy(item, queue->storage + queue->head * queue->item_size,
+           queue->item_size);
+  }
+  queue->head = (queue->head + 1) % queue->length;
+  queue->count--;
+}
+
+// Post a member to its queue set, as FreeRTOS does for every item sent to
+// a member queue or semaphore.
+void notifySet(QueueDefinition* member) {
+  QueueDefinition* set = member->set;
+  if (set == nullptr) {
+    return;
+  }
+  configASSERT(set->count < set->length);
+  pushItem(set, &member);
+}
+
+BaseType_t send(QueueDefinition* queue, const void* item, TickType_t ticks) {
+  std::unique_lock<std::mutex> lock(rtosMutex());
+  if (!waitFor(lock, ticks,
+               [queue]() { return queue->count < queue->length; })) {
+    return pdFALSE;
+  }
+  pushItem(queue, item);
+  notifySet(queue);
+  rtosCondition().notify_all();
+  return pdTRUE;
+}
+
+}  // namespace
+
+void host_assert_failed(const char* expr, const char* file, int line) {
+  fprintf(stderr, "%s:%d: assertion failed: %s\n", file, line, expr);
+  abort();
+}
+
+void vPortEnterCritical(portMUX_TYPE* mux) {
+  interruptLock().lock();
+  mux->count++;
+}
+
+void vPortExitCritical(portMUX_TYPE* mux) {
+  mux->count--;
+  interruptLock().unlock();
+}
+
+BaseType_t xPortInIsrContext() { return isr_depth > 0; }
+
+TaskHandle_t xTaskGetCurrentTaskHandle() {
+  static thread_local char task;
+  return reinterpret_cast<TaskHandle_t>(&task);
+}
+
+void vTaskDelay(TickType_t ticks) { delay(ticks * portTICK_PERIOD_MS); }
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size) {
+  return createQueue(QueueDefinition::kQueue, length, item_size);
+}
+
+void vQueueDelete(QueueHandle_t queue) {
+  delete[] queue->storage;
+  delete queue;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void* item,
+                      TickType_t ticks) {
+  return send(queue, item, ticks);
+}
+
+BaseType_t xQueueSendFromISR(QueueHandle_t queue, const void* item,
+                             BaseType_t* higher_priority_task_woken) {
+  return send(queue, item, 0);
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void* item, TickType_t ticks) {
+  std::unique_lock<std::mutex> lock(rtosMutex());
+  if (!waitFor(lock, ticks, [queue]() { return queue->count > 0; })) {
+    return pdFALSE;
+  }
+  popItem(queue, item);
+  rtosCondition().notify_all();
+  return pdTRUE;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue) {
+  std::lock_guard<std::mutex> lock(rtosMutex());
+  return queue->count;
+}
+
+UBaseType_t uxQueueSpacesAvailable(QueueHandle_t queue) {
+  std::lock_guard<std::mutex> lock(rtosMutex());
+  return queue->length - queue->count;
+}
+
+QueueSetHandle_t xQueueCreateSet(UBaseType_t length) {
+  return createQueue(QueueDefinition::kSet, length, sizeof(QueueDefinition*));
+}
+
+BaseType_t xQueueAddToSet(QueueSetMemberHandle_t member,
+                          QueueSetHandle_t set) {
+  std::lock_guard<std::mutex> lock(rtosMutex());
+  if (member->set != nullptr || member->count != 0) {
+    return pdFAIL;
+  }
+  member->set = set;
+  return pdPASS;
+}
+
+BaseType_t xQueueRemoveFromSet(QueueSetMemberHandle_t member,
+                               QueueSetHandle_t set) {
+  std::lock_guard<std::mutex> lock(rtosMutex());
+  if (member->set != set || member->count != 0) {
+    return pdFAIL;
+  }
+  member->set = nullptr;
+  return pdPASS;
+}
+
+QueueSetMemberHandle_t xQueueSelectFromSet(QueueSetHandle_t set,
+                                           TickType_t ticks) {
+  std::unique_lock<std::mutex> lock(rtosMutex());
+  if (!waitFor(lock, ticks, [set]() { return set->count > 0; })) {
+    return nullptr;
+  }
+  QueueDefinition* member;
+  popItem(set, &member);
+  return member;
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary() {
+  return createQueue(QueueDefinition::kSemaphore, 1, 0);
+}
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t max_count,
+                                           UBaseType_t initial_count) {
+  auto* semaphore = createQueue(QueueDefinition::kSemaphore, max_count, 0);
+  semaphore->count = initial_count;
+  return semaphore;
+}
+
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutex() {
+  return createQueue(QueueDefinition::kRecursiveMutex, 1, 0);
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t semaphore) { vQueueDelete(semaphore); }
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticks) {
+  return xQueueReceive(semaphore, nullptr, ticks);
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore) {
+  return send(semaphore, nullptr, 0);
+}
+
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t semaphore,
+                                 BaseType_t* higher_priority_task_woken) {
+  return send(semaphore, nullptr, 0);
+}
+
+BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t mutex,
+                                   TickType_t ticks) {
+  const TaskHandle_t task = xTaskGetCurrentTaskHandle();
+  std::unique_lock<std::mutex> lock(rtosMutex());
+  if (mutex->owner == task) {
+    mutex->depth++;
+    return pdTRUE;
+  }
+  if (!waitFor(lock, ticks, [mutex]() { return mutex->depth == 0; })) {
+    return pdFALSE;
+  }
+  mutex->owner = task;
+  mutex->depth = 1;
+  return pdTRUE;
+}
+
+BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t mutex) {
+  std::lock_guard<std::mutex> lock(rtosMutex());
+  if (mutex->owner != xTaskGetCurrentTaskHandle() || mutex->depth == 0) {
+    return pdFALSE;
+  }
+  if (--mutex->depth == 0) {
+    mutex->owner = nullptr;
+    rtosCondition().notify_all();
+  }
+  return pdTRUE;
+}
+
+EventGroupHandle_t xEventGroupCreate() {
+  auto* group = new EventGroupDef_t();
+  group->bits.store(0);
+  return group;
+}
+
+void vEventGroupDelete(EventGroupHandle_t group) { delete group; }
+
+EventBits_t xEventGroupSetBits(EventGroupHandle_t group, EventBits_t bits) {
+  return group->bits.fetch_or(bits) | bits;
+}
+
+EventBits_t xEventGroupClearBits(EventGroupHandle_t group, EventBits_t bits) {
+  return group->bits.fetch_and(~bits);
+}
+
+EventBits_t xEventGroupGetBits(EventGroupHandle_t group) {
+  return group->bits.load();
+}
+
+//////////////////////////////////////////////////////////////////////////
+// esp_timer
+
+struct esp_timer {
+  esp_timer_create_args_t args;
+  bool armed;
+  int64_t alarm;
+  uint64_t period;
+};
+
+namespace {
+
+// The dispatcher thread runs the callbacks of expired timers one at a
+// time, like the esp_timer task. Periodic timers are re-armed before their
+// callback runs.
+class TimerService {
+ public:
+  ~TimerService() {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      stopping = true;
+    }
+    condition.notify_all();
+    if (thread.joinable()) {
+      thread.join();
+    }
+  }
+
+  void add(esp_timer* timer) {
+    std::lock_guard<std::mutex> lock(mutex);
+    timers.push_back(timer);
+    if (!thread.joinable()) {
+      thread = std::thread([this]() { run(); });
+    }
+  }
+
+  void run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stopping) {
+      const int64_t now = peekNow();
+      esp_timer* due = nullptr;
+      int64_t next_alarm = INT64_MAX;
+      for (esp_timer* timer : timers) {
+        if (!timer->armed) {
+          continue;
+        }
+        if (timer->alarm <= now &&
+            (due == nullptr || timer->alarm < due->alarm)) {
+          due = timer;
+        }
+        next_alarm = std::min(next_alarm, timer->alarm);
+      }
+      if (due != nullptr) {
+        if (due->period != 0) {
+          due->alarm += due->period;
+          if (due->args.skip_unhandled_events && due->alarm <= now) {
+            due->alarm = now + due->period;
+          }
+        } else {
+          due->armed = false;
+        }
+        const esp_timer_cb_t callback = due->args.callback;
+        void* arg = due->args.arg;
+        running++;
+        lock.unlock();
+        callback(arg);
+        lock.lock();
+        running--;
+        condition.notify_all();
+        continue;
+      }
+      if (manual_clock.load() || next_alarm == INT64_MAX) {
+        condition.wait_for(lock, std::chrono::milliseconds(1));
+      } else {
+        condition.wait_until(lock,
+                             epoch() + std::chrono::microseconds(next_alarm));
+      }
+    }
+  }
+
+  std::mutex mutex;
+  std::condition_variable condition;
+  std::vector<esp_timer*> timers;
+  std::thread thread;
+  bool stopping = false;
+  std::atomic<int> running{0};
+};
+
+TimerService& timerService() {
+  static TimerService service;
+  return service;
+}
+
+void notifyClockChange() { timerService().condition.notify_all(); }
+
+}  // namespace
+
+int64_t esp_timer_get_time() {
+  if (manual_clock.load()) {
+    return manual_now.fetch_add(auto_advance.load()) + auto_advance.load();
+  }
+  return realNow();
+}
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t* args,
+                           esp_timer_handle_t* out_handle) {
+  auto* timer = new esp_timer();
+  timer->args = *args;
+  timer->armed = false;
+  timer->alarm = 0;
+  timer->period = 0;
+  timerService().add(timer);
+  *out_handle = timer;
+  return ESP_OK;
+}
+
+namespace {
+
+esp_err_t startTimer(esp_timer_handle_t timer, uint64_t timeout_us,
+                     uint64_t period_us) {
+  TimerService& service = timerService();
+  {
+    std::lock_guard<std::mutex> lock(service.mutex);
+    if (timer->armed) {
+      return ESP_ERR_INVALID_STATE;
+    }
+    timer->armed = true;
+    timer->alarm = esp_timer_get_time() + timeout_us;
+    timer->period = period_us;
+  }
+  service.condition.notify_all();
+  return ESP_OK;
+}
+
+}  // namespace
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us) {
+  return startTimer(timer, timeout_us, 0);
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer,
+                                   uint64_t period_us) {
+  return startTimer(timer, period_us, period_us);
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer) {
+  std::lock_guard<std::mutex> lock(timerService().mutex);
+  if (!timer->armed) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  timer->armed = false;
+  return ESP_OK;
+}
+
+// As in ESP-IDF, deleting a timer does not wait for a callback that is
+// already running.
+esp_err_t esp_timer_delete(esp_timer_handle_t timer) {
+  TimerService& service = timerService();
+  std::lock_guard<std::mutex> lock(service.mutex);
+  if (timer->armed) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  service.timers.erase(
+      std::find(service.timers.begin(), service.timers.end(), timer));
+  // poison the memory to expose uses after deletion
+  memset(static_cast<void*>(timer), 0xa5, sizeof(*timer));
+  delete timer;
+  return ESP_OK;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// GPIO
+
+gpio_dev_t GPIO;
+
+namespace {
+
+const int kPinCount = GPIO_PIN_COUNT;
+
+struct Pin {
+  int level;
+  gpio_int_type_t intr_type;
+  bool intr_enabled;
+  gpio_isr_t handler;
+  void* handler_arg;
+  void (*arduino_handler)(void*);
+  void* arduino_arg;
+  int arduino_mode;
+};
+
+Pin pins[kPinCount];
+bool isr_service_installed = false;
+void (*raw_handler)(void*) = nullptr;
+void* raw_handler_arg = nullptr;
+std::atomic<uint32_t> gpio_interrupt_count(0);
+
+int raw_handle_storage;
+
+bool edgeMatches(int mode_rising, int mode_falling, int old_level,
+                 int new_level) {
+  if (old_level == new_level) {
+    return false;
+  }
+  return new_level ? mode_rising : mode_falling;
+}
+
+void runGpioInterrupt() {
+  host::IsrScope isr;
+  gpio_interrupt_count++;
+  if (raw_handler != nullptr) {
+    raw_handler(raw_handler_arg);
+  } else if (isr_service_installed) {
+    const uint64_t status =
+        GPIO.status | ((uint64_t)GPIO.status1.intr_st << 32);
+    for (int pin = 0; pin < kPinCount; pin++) {
+      if ((status >> pin) & 1) {
+        if (pins[pin].handler != nullptr) {
+          pins[pin].handler(pins[pin].handler_arg);
+        }
+        if (pin < 32) {
+          GPIO.status_w1tc = (uint32_t)1 << pin;
+        } else {
+          GPIO.status1_w1tc.intr_st = 1 << (pin - 32);
+        }
+      }
+    }
+  }
+  // apply the write-one-to-clear registers
+  GPIO.status = GPIO.status & ~GPIO.status_w1tc;
+  GPIO.status_w1tc = 0;
+  GPIO.status1.intr_st = GPIO.status1.intr_st & ~GPIO.status1_w1tc.intr_st;
+  GPIO.status1_w1tc.val = 0;
+}
+
+}  // namespace
+
+esp_err_t gpio_set_intr_type(gpio_num_t gpio_num, gpio_int_type_t intr_type) {
+  pins[gpio_num].intr_type = intr_type;
+  pins[gpio_num].intr_enabled = intr_type != GPIO_INTR_DISABLE;
+  return ESP_OK;
+}
+
+esp_err_t gpio_intr_enable(gpio_num_t gpio_num) {
+  pins[gpio_num].intr_enabled = true;
+  return ESP_OK;
+}
+
+esp_err_t gpio_intr_disable(gpio_num_t gpio_num) {
+  pins[gpio_num].intr_enabled = false;
+  return ESP_OK;
+}
+
+int gpio_get_level(gpio_num_t gpio_num) { return pins[gpio_num].level; }
+
+esp_err_t gpio_install_isr_service(int intr_alloc_flags) {
+  if (isr_service_installed) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  if (raw_handler != nullptr) {
+    return ESP_ERR_NOT_FOUND;
+  }
+  isr_service_installed = true;
+  return ESP_OK;
+}
+
+void gpio_uninstall_isr_service() { isr_service_installed = false; }
+
+esp_err_t gpio_isr_handler_add(gpio_num_t gpio_num, gpio_isr_t isr_handler,
+                               void* args) {
+  if (!isr_service_installed) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  std::lock_guard<std::recursive_mutex> lock(interruptLock());
+  pins[gpio_num].handler = isr_handler;
+  pins[gpio_num].handler_arg = args;
+  return ESP_OK;
+}
+
+esp_err_t gpio_isr_handler_remove(gpio_num_t gpio_num) {
+  if (!isr_service_installed) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  std::lock_guard<std::recursive_mutex> lock(interruptLock());
+  pins[gpio_num].handler = nullptr;
+  pins[gpio_num].handler_arg = nullptr;
+  return ESP_OK;
+}
+
+esp_err_t gpio_isr_register(void (*fn)(void*), void* arg, int intr_alloc_flags,
+                            gpio_isr_handle_t* handle) {
+  if (isr_service_installed || raw_handler != nullptr) {
+    return ESP_ERR_NOT_FOUND;
+  }
+  std::lock_guard<std::recursive_mutex> lock(interruptLock());
+  raw_handler = fn;
+  raw_handler_arg = arg;
+  if (handle != nullptr) {
+    *handle = reinterpret_cast<intr_handle_t>(&raw_handle_storage);
+  }
+  return ESP_OK;
+}
+
+esp_err_t esp_intr_free(intr_handle_t handle) {
+  std::lock_guard<std::recursive_mutex> lock(interruptLock());
+  raw_handler = nullptr;
+  raw_handler_arg = nullptr;
+  return ESP_OK;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Arduino
+
+unsigned long millis() { return esp_timer_get_time() / 1000; }
+
+unsigned long micros() { return esp_timer_get_time(); }
+
+void delay(uint32_t ms) { delayMicroseconds(1000 * ms); }
+
+void delayMicroseconds(uint32_t us) {
+  if (manual_clock.load()) {
+    host::advance(us);
+  } else {
+    std::this_thread::sleep_for(std::chrono::microseconds(us));
+  }
+}
+
+void pinMode(uint8_t pin, uint8_t mode) {}
+
+int digitalRead(uint8_t pin) { return pins[pin].level; }
+
+void digitalWrite(uint8_t pin, uint8_t level) { host::setPinLevel(pin, level); }
+
+void attachInterruptArg(uint8_t pin, void (*handler)(void*), void* arg,
+                        int mode) {
+  std::lock_guard<std::recursive_mutex> lock(interruptLock());
+  pins[pin].arduino_handler = handler;
+  pins[pin].arduino_arg = arg;
+  pins[pin].arduino_mode = mode;
+}
+
+void detachInterrupt(uint8_t pin) {
+  std::lock_guard<std::recursive_mutex> lock(interruptLock());
+  pins[pin].arduino_handler = nullptr;
+  pins[pin].arduino_arg = nullptr;
+}
+
+// The interrupt level of the calling thread. Raising it from zero excludes
+// interrupt handlers and critical sections on other threads.
+uint32_t xt_rsil(uint32_t level) {
+  const uint32_t previous = ps_level;
+  if (previous == 0 && level != 0) {
+    interruptLock().lock();
+  }
+  ps_level = level;
+  return previous;
+}
+
+void xt_wsr_ps(uint32_t state) {
+  if (ps_level != 0 && state == 0) {
+    interruptLock().unlock();
+  } else if (ps_level == 0 && state != 0) {
+    interruptLock().lock();
+  }
+  ps_level = state;
+}
+
+void noInterrupts() { xt_rsil(15); }
+
+void interrupts() { xt_rsil(0); }
+
+//////////////////////////////////////////////////////////////////////////
+// Controls
+
+namespace host {
+
+void useRealClock() { manual_clock.store(false); }
+
+void useManualClock(int64_t start_us) {
+  manual_now.store(start_us);
+  manual_clock.store(true);
+}
+
+bool isManualClock() { return manual_clock.load(); }
+
+void setTime(int64_t us) {
+  manual_now.store(us);
+  notifyClockChange();
+}
+
+void advance(int64_t us) {
+  manual_now.fetch_add(us);
+  notifyClockChange();
+}
+
+void setAutoAdvance(int64_t us) { auto_advance.store(us); }
+
+void setWakeJitter(int64_t us) { wake_jitter.store(us); }
+
+uint32_t getInterruptLevel() { return ps_level; }
+
+IsrScope::IsrScope() {
+  interruptLock().lock();
+  isr_depth++;
+}
+
+IsrScope::~IsrScope() {
+  isr_depth--;
+  interruptLock().unlock();
+}
+
+void setPinLevel(uint8_t pin, int level) {
+  Pin& p = pins[pin];
+  const int old_level = p.level;
+  p.level = level;
+  if (p.arduino_handler != nullptr &&
+      edgeMatches(p.arduino_mode & RISING, p.arduino_mode & FALLING,
+                  old_level, level)) {
+    IsrScope isr;
+    p.arduino_handler(p.arduino_arg);
+  }
+  const bool rising = p.intr_type == GPIO_INTR_POSEDGE ||
+                      p.intr_type == GPIO_INTR_ANYEDGE;
+  const bool falling = p.intr_type == GPIO_INTR_NEGEDGE ||
+                       p.intr_type == GPIO_INTR_ANYEDGE;
+  if (p.intr_enabled && edgeMatches(rising, falling, old_level, level)) {
+    raiseGpioInterrupt((uint64_t)1 << pin);
+  }
+}
+
+void raiseGpioInterrupt(uint64_t mask) {
+  {
+    IsrScope isr;
+    GPIO.status = GPIO.status | (uint32_t)mask;
+    GPIO.status1.intr_st = GPIO.status1.intr_st | (uint32_t)(mask >> 32);
+  }
+  runGpioInterrupt();
+}
+
+uint32_t getGpioInterruptCount() { return gpio_interrupt_count.load(); }
+
+int getRunningTimerCallbacks() { return timerService().running.load(); }
+
+void waitForTimers() {
+  TimerService& service = timerService();
+  std::unique_lock<std::mutex> lock(service.mutex);
+  service.condition.wait(lock, [&service]() {
+    if (service.running.load() != 0) {
+      return false;
+    }
+    const int64_t now = peekNow();
+    for (esp_timer* timer : service.timers) {
+      if (timer->armed && timer->alarm <= now) {
+        return false;
+      }
+    }
+    return true;
+  });
+}
+
+}  // namespace host
@@ -0,0 +1,78 @@
+#ifndef REACTESP_TEST_HOST_STUBS_HOST_H_
+#define REACTESP_TEST_HOST_STUBS_HOST_H_
+
+// Controls for the host stand-ins, for use by the tests and benchmarks.
+
+#include <stdint.h>
+
+namespace host {
+
+/**
+ * @brief Run the clock in real time (the default).
+ */
+void useRealClock();
+
+/**
+ * @brief Run the clock manually, starting at start_us.
+ *
+ * The clock only moves when advance() or setTime() is called, when a
+ * blocking call times out (the time is moved to its deadline plus the wake
+ * jitter), and by the auto-advance step on every read.
+ */
+void useManualClock(int64_t start_us = 0);
+bool isManualClock();
+void setTime(int64_t us);
+void advance(int64_t us);
+void setAutoAdvance(int64_t us);
+void setWakeJitter(int64_t us);
+
+/**
+ * @brief Interrupt level set with xt_rsil() by the calling thread.
+ */
+uint32_t getInterruptLevel();
+
+/**
+ * @brief Scope that runs the enclosed code as an interrupt handler.
+ *
+ * xPortInIsrContext() returns true and critical sections on other threads
+ * are excluded, as on a single core.
+ */
+class IsrScope {
+ public:
+  IsrScope();
+  ~IsrScope();
+};
+
+/**
+ * @brief Set the level of an input pin.
+ *
+ * If an edge interrupt is enabled for the pin and the change matches it,
+ * the interrupt status bit is set and the GPIO interrupt is run: either
+ * the ISR service, which calls the handler of each pending pin, or the
+ * handler installed with gpio_isr_register().
+ */
+void setPinLevel(uint8_t pin, int level);
+
+/**
+ * @brief Raise GPIO interrupt status bits directly and run the interrupt.
+ */
+void raiseGpioInterrupt(uint64_t mask);
+
+/**
+ * @brief Number of times the GPIO interrupt has run.
+ */
+uint32_t getGpioInterruptCount();
+
+/**
+ * @brief Number of esp_timer callbacks currently running.
+ */
+int getRunningTimerCallbacks();
+
+/**
+ * @brief Wait until no esp_timer callback is due or running.
+ */
+void waitForTimers();
+
+}  // namespace host
+
+#endif  // REACTESP_TEST_HOST_STUBS_HOST_H_
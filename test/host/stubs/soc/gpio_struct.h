@@ -0,0 +1,27 @@
+#ifndef REACTESP_TEST_HOST_STUBS_SOC_GPIO_STRUCT_H_
+#define REACTESP_TEST_HOST_STUBS_SOC_GPIO_STRUCT_H_
+
+#include <stdint.h>
+
+// The interrupt status registers of the ESP32 GPIO peripheral. Writes to
+// the w1tc registers clear the corresponding status bits; see host.cpp.
+typedef union {
+  struct {
+    uint32_t intr_st : 8;
+    uint32_t reserved8 : 24;
+  };
+  uint32_t val;
+} gpio_status1_reg_t;
+
+typedef volatile struct gpio_dev_s {
+  uint32_t status;
+  uint32_t status_w1ts;
+  uint32_t status_w1tc;
+  gpio_status1_reg_t status1;
+  gpio_status1_reg_t status1_w1ts;
+  gpio_status1_reg_t status1_w1tc;
+} gpio_dev_t;
+
+extern gpio_dev_t GPIO;
+
+#endif  // REACTESP_TEST_HOST_STUBS_SOC_GPIO_STRUCT_H_
@@ -0,0 +1,165 @@
+// Run a mixed steady-state workload for millions of ticks with the
+// allocation check enabled and verify that the loop never allocates.
+
+#include <freertos/event_groups.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+
+#include <memory>
+
+#include "ReactESP.h"
+#include "host.h"
+#include "host_test.h"
+
+using namespace reactesp;
+
+namespace {
+
+const uint64_t kTicks = 4000000;
+
+class FakeStream : public Stream {
+ public:
+  int available() override { return pending; }
+  int read() override { return pending > 0 ? (pending--, 'x') : -1; }
+  int peek() override { return pending > 0 ? 'x' : -1; }
+  size_t write(uint8_t c) override { return 1; }
+  int availableForWrite() override { return 64; }
+
+  int pending = 0;
+};
+
+uint32_t handled_violations = 0;
+
+// keeps the compiler from eliding the test allocations
+void* volatile sink;
+
+void countViolation(size_t size) { handled_violations++; }
+
+}  // namespace
+
+int main() {
+  host::useManualClock(1000);
+  host::setAutoAdvance(1);
+
+  EventLoop loop;
+  FakeStream stream;
+  QueueHandle_t queue = xQueueCreate(8, sizeof(uint32_t));
+  SemaphoreHandle_t semaphore = xSemaphoreCreateCounting(8, 0);
+  EventGroupHandle_t event_group = xEventGroupCreate();
+  Channel<uint32_t> channel(16);
+
+  uint64_t repeats = 0;
+  uint64_t fast_repeats = 0;
+  uint64_t triggered = 0;
+  uint64_t received = 0;
+  uint64_t taken = 0;
+  uint64_t bits_seen = 0;
+  uint64_t stream_bytes = 0;
+  uint64_t interrupts = 0;
+  uint64_t channel_items = 0;
+  uint64_t barrier_rounds = 0;
+  uint64_t barrier_timeouts = 0;
+  int level = 0;
+
+  // every round re-arms the barrier timeout
+  BarrierEvent* barrier = nullptr;
+  barrier = loop.onBarrier(
+      2,
+      [&](bool timed_out) {
+        barrier_rounds++;
+        if (timed_out) {
+          barrier_timeouts++;
+        }
+        barrier->reset();
+      },
+      3);
+
+  TriggeredEvent* trigger = loop.onTrigger([&]() { triggered++; });
+  loop.onRepeatMicros(250, [&]() {
+    fast_repeats++;
+    trigger->trigger();
+  });
+  loop.onRepeat(1, [&]() {
+    repeats++;
+    const uint32_t value = repeats;
+    xQueueSend(queue, &value, 0);
+    xSemaphoreGive(semaphore);
+    xEventGroupSetBits(event_group, 0x01);
+    channel.send(value);
+    stream.pending += 3;
+    level = !level;
+    host::setPinLevel(4, level);
+    // arrivals stop for a while so that some rounds time out
+    if (repeats % 16 < 8) {
+      barrier->arrive();
+    }
+  });
+  loop.onQueue(queue, [&]() {
+    uint32_t value;
+    while (xQueueReceive(queue, &value, 0) == pdTRUE) {
+      received++;
+    }
+  });
+  loop.onSemaphore(semaphore, [&]() { taken++; });
+  loop.onEventBits(event_group, 0x01, [&](EventBits_t bits) { bits_seen++; });
+  loop.onAvailable(stream, [&]() {
+    while (stream.read() >= 0) {
+      stream_bytes++;
+    }
+  });
+  loop.onInterrupt(4, CHANGE, [&]() { interrupts++; });
+  loop.onReceive<uint32_t>(channel, [&](const uint32_t* items, size_t count) {
+    channel_items += count;
+  });
+  loop.onTick([]() {});
+
+  // let the containers reach their steady-state capacity
+  for (int i = 0; i < 10000; i++) {
+    loop.tick();
+  }
+
+  AllocationGuard::setViolationHandler(countViolation);
+  loop.enableAllocationCheck();
+  for (uint64_t i = 0; i < kTicks; i++) {
+    loop.tick();
+  }
+  loop.enableAllocationCheck(false);
+
+  CHECK_EQ(AllocationGuard::getViolationCount(), 0);
+  CHECK_EQ(handled_violations, 0);
+  CHECK(repeats > 1000);
+  CHECK(fast_repeats > 4 * repeats - 10);
+  CHECK(triggered > 0);
+  CHECK(received > repeats - 10);
+  CHECK(taken > 0);
+  CHECK(bits_seen > 0);
+  CHECK(stream_bytes > 3 * repeats - 30);
+  CHECK(interrupts > repeats - 10);
+  CHECK(channel_items > repeats - 10);
+  CHECK(barrier_rounds > repeats / 3);
+  CHECK(barrier_timeouts > 0);
+  CHECK(barrier_timeouts < barrier_rounds);
+
+  // allocations inside the loop are reported through the handler, for the
+  // plain, array and aligned forms of operator new
+  loop.onDelay(0, []() {
+    struct alignas(64) Aligned {
+      char data[64];
+    };
+    std::unique_ptr<int> plain(new int(1));
+    std::unique_ptr<int[]> array(new int[4]);
+    std::unique_ptr<Aligned> aligned(new Aligned());
+    sink = plain.get();
+    sink = array.get();
+    sink = aligned.get();
+  });
+  loop.enableAllocationCheck();
+  loop.tick();
+  loop.tick();
+  loop.enableAllocationCheck(false);
+  CHECK_EQ(handled_violations, 3);
+  CHECK_EQ(AllocationGuard::getViolationCount(), 3);
+
+  printf("%llu ticks without allocation\n", (unsigned long long)kTicks);
+  return 0;
+}
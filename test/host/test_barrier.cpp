@@ -0,0 +1,182 @@
+// BarrierEvent rounds, timeouts and resets.
+
+#include "ReactESP.h"
+#include "host.h"
+#include "host_test.h"
+
+using namespace reactesp;
+
+namespace {
+
+struct Rounds {
+  int calls = 0;
+  int timeouts = 0;
+
+  barrier_callback callback() {
+    return [this](bool timed_out) {
+      this->calls++;
+      if (timed_out) {
+        this->timeouts++;
+      }
+    };
+  }
+};
+
+void testArrivals() {
+  EventLoop loop;
+  Rounds rounds;
+  BarrierEvent* barrier = loop.onBarrier(3, rounds.callback());
+  CHECK_EQ(barrier->getRemaining(), 3);
+  barrier->arrive();
+  barrier->arrive();
+  loop.tick();
+  CHECK_EQ(rounds.calls, 0);
+  CHECK_EQ(barrier->getRemaining(), 1);
+  barrier->arrive();
+  // extra arrivals do not wrap the counter around
+  barrier->arrive();
+  CHECK_EQ(barrier->getRemaining(), 0);
+  loop.tick();
+  CHECK_EQ(rounds.calls, 1);
+  CHECK_EQ(rounds.timeouts, 0);
+  loop.tick();
+  CHECK_EQ(rounds.calls, 1);
+
+  // same count again, then a new one
+  barrier->reset();
+  CHECK_EQ(barrier->getRemaining(), 3);
+  barrier->reset(1);
+  CHECK_EQ(barrier->getRemaining(), 1);
+  barrier->arrive();
+  loop.tick();
+  CHECK_EQ(rounds.calls, 2);
+  // reset() keeps the last count
+  barrier->reset();
+  CHECK_EQ(barrier->getRemaining(), 1);
+  barrier->remove(&loop);
+  loop.tick();
+}
+
+// A count of 0 fires without arrivals, both when adding and resetting
+void testZeroCount() {
+  EventLoop loop;
+  Rounds rounds;
+  BarrierEvent* barrier = loop.onBarrier(0, rounds.callback(), 10);
+  loop.tick();
+  CHECK_EQ(rounds.calls, 1);
+  barrier->reset(2);
+  barrier->arrive();
+  barrier->reset(0);
+  CHECK_EQ(barrier->getRemaining(), 0);
+  loop.tick();
+  CHECK_EQ(rounds.calls, 2);
+  CHECK_EQ(rounds.timeouts, 0);
+  // the timeout of the abandoned round does not fire
+  host::advance(20000);
+  loop.tick();
+  CHECK_EQ(rounds.calls, 2);
+  barrier->remove(&loop);
+  loop.tick();
+}
+
+// Expired timeouts trigger the barrier, which runs on the next tick
+void tickTwice(EventLoop& loop) {
+  loop.tick();
+  loop.tick();
+}
+
+// The timeout is measured from the last add() or reset()
+void testTimeout() {
+  EventLoop loop;
+  Rounds rounds;
+  BarrierEvent* barrier = loop.onBarrier(2, rounds.callback(), 10);
+  barrier->arrive();
+  host::advance(9000);
+  tickTwice(loop);
+  CHECK_EQ(rounds.calls, 0);
+  host::advance(1000);
+  tickTwice(loop);
+  CHECK_EQ(rounds.calls, 1);
+  CHECK_EQ(rounds.timeouts, 1);
+  CHECK_EQ(barrier->getRemaining(), 0);
+  // late arrivals are ignored
+  barrier->arrive();
+  tickTwice(loop);
+  CHECK_EQ(rounds.calls, 1);
+
+  // restarting while the timer is queued pushes the deadline back
+  barrier->reset();
+  host::advance(6000);
+  tickTwice(loop);
+  barrier->reset();
+  host::advance(6000);
+  tickTwice(loop);
+  CHECK_EQ(rounds.calls, 1);
+  host::advance(4000);
+  tickTwice(loop);
+  CHECK_EQ(rounds.calls, 2);
+  CHECK_EQ(rounds.timeouts, 2);
+
+  // a round that completes in time
+  barrier->reset();
+  barrier->arrive();
+  barrier->arrive();
+  tickTwice(loop);
+  CHECK_EQ(rounds.calls, 3);
+  CHECK_EQ(rounds.timeouts, 2);
+  host::advance(20000);
+  tickTwice(loop);
+  CHECK_EQ(rounds.calls, 3);
+
+  // removing the barrier while its timer is queued
+  barrier->reset();
+  barrier->remove(&loop);
+  tickTwice(loop);
+  host::advance(20000);
+  tickTwice(loop);
+  CHECK_EQ(rounds.calls, 3);
+}
+
+// Rounds reset from the callback reuse the same timer: the timed queue does
+// not grow
+void testRepeatedRounds() {
+  EventLoop loop;
+  int calls = 0;
+  int timeouts = 0;
+  BarrierEvent* barrier = nullptr;
+  barrier = loop.onBarrier(
+      1,
+      [&](bool timed_out) {
+        calls++;
+        if (timed_out) {
+          timeouts++;
+        }
+        barrier->reset();
+      },
+      5);
+  for (int i = 0; i < 1000; i++) {
+    // arrivals stop half way through
+    if (i < 500) {
+      barrier->arrive();
+    }
+    host::advance(3000);
+    loop.tick();
+  }
+  CHECK(calls >= 650);
+  CHECK(timeouts >= 150);
+  CHECK(loop.getTimedEventQueueSize() <= 1);
+  barrier->remove(&loop);
+  loop.tick();
+}
+
+}  // namespace
+
+int main() {
+  host::useManualClock(1000000);
+  testArrivals();
+  testZeroCount();
+  testTimeout();
+  testRepeatedRounds();
+  printf("barrier ok\n");
+  return 0;
+}
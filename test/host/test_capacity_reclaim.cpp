@@ -0,0 +1,117 @@
+// Capacity reclaim after a burst of events: the low-water threshold, the
+// hold time and the headroom left after shrinking.
+
+#include <vector>
+
+#include "ReactESP.h"
+#include "host.h"
+#include "host_test.h"
+
+using namespace reactesp;
+
+namespace {
+
+const size_t kPointer = sizeof(void*);
+
+// Grow the untimed list to 64 entries and remove all but `keep` of them
+std::vector<TickEvent*> burst(EventLoop& loop, size_t keep) {
+  std::vector<TickEvent*> events;
+  for (int i = 0; i < 64; i++) {
+    events.push_back(loop.onTick([]() {}));
+  }
+  while (events.size() > keep) {
+    events.back()->remove(&loop);
+    events.pop_back();
+  }
+  return events;
+}
+
+void testReclaimAfterHold() {
+  // the occupancy first goes low at time 0
+  host::useManualClock(0);
+  EventLoop loop;
+  loop.setCapacityReclaim(25, 100);
+  burst(loop, 4);
+  loop.tick();
+  host::advance(50000);
+  loop.tick();
+  CHECK_EQ(loop.getReclaimedBytes(), 0);
+  host::advance(50000);
+  loop.tick();
+  // shrunk to twice the size, from 64 to 8 entries
+  CHECK_EQ(loop.getReclaimedBytes(), (64 - 8) * kPointer);
+
+  // at 4 of 8 entries the occupancy is above the threshold
+  host::advance(1000000);
+  loop.tick();
+  CHECK_EQ(loop.getReclaimedBytes(), (64 - 8) * kPointer);
+}
+
+// Occupancy above the threshold restarts the hold time
+void testHoldRestart() {
+  host::useManualClock(1000000);
+  EventLoop loop;
+  loop.setCapacityReclaim(25, 100);
+  burst(loop, 4);
+  loop.tick();
+  host::advance(80000);
+  loop.tick();
+  std::vector<TickEvent*> more;
+  for (int i = 0; i < 20; i++) {
+    more.push_back(loop.onTick([]() {}));
+  }
+  loop.tick();
+  for (TickEvent* event : more) {
+    event->remove(&loop);
+  }
+  host::advance(80000);
+  loop.tick();
+  CHECK_EQ(loop.getReclaimedBytes(), 0);
+  host::advance(80000);
+  loop.tick();
+  CHECK_EQ(loop.getReclaimedBytes(), 0);
+  host::advance(20000);
+  loop.tick();
+  CHECK_EQ(loop.getReclaimedBytes(), (64 - 8) * kPointer);
+}
+
+// Never below the reserved capacity, and not while the allocation check is
+// enabled
+void testLimits() {
+  host::useManualClock(1000000);
+  EventLoop loop;
+  loop.reserve(0, 16, 0);
+  loop.setCapacityReclaim(25, 10);
+  burst(loop, 2);
+  loop.enableAllocationCheck();
+  for (int i = 0; i < 5; i++) {
+    host::advance(10000);
+    loop.tick();
+  }
+  loop.enableAllocationCheck(false);
+  CHECK_EQ(loop.getReclaimedBytes(), 0);
+  for (int i = 0; i < 2; i++) {
+    host::advance(10000);
+    loop.tick();
+  }
+  CHECK_EQ(loop.getReclaimedBytes(), (64 - 16) * kPointer);
+
+  // disabled
+  EventLoop idle;
+  burst(idle, 0);
+  for (int i = 0; i < 5; i++) {
+    host::advance(1000000);
+    idle.tick();
+  }
+  CHECK_EQ(idle.getReclaimedBytes(), 0);
+}
+
+}  // namespace
+
+int main() {
+  testReclaimAfterHold();
+  testHoldRestart();
+  testLimits();
+  printf("capacity reclaim ok\n");
+  return 0;
+}
@@ -0,0 +1,48 @@
+// The interrupt-disabling critical section used on targets other than
+// ESP32. Built without the library; see the Makefile.
+
+#include "critical_section.h"
+#include "host.h"
+#include "host_test.h"
+
+using namespace reactesp;
+
+int main() {
+  CriticalSection outer;
+  CriticalSection inner;
+
+  // interrupts are enabled again after a single section
+  CHECK_EQ(host::getInterruptLevel(), 0);
+  outer.enter();
+  CHECK_EQ(host::getInterruptLevel(), 15);
+  outer.exit();
+  CHECK_EQ(host::getInterruptLevel(), 0);
+
+  // nested sections keep interrupts disabled until the outermost exit
+  outer.enter();
+  inner.enter();
+  inner.exit();
+  CHECK_EQ(host::getInterruptLevel(), 15);
+  outer.exit();
+  CHECK_EQ(host::getInterruptLevel(), 0);
+
+  // re-entering the same section
+  outer.enter();
+  outer.enter();
+  outer.exit();
+  CHECK_EQ(host::getInterruptLevel(), 15);
+  outer.exit();
+  CHECK_EQ(host::getInterruptLevel(), 0);
+
+  // a section entered with interrupts disabled by the caller, as in an
+  // interrupt handler, leaves them disabled
+  const uint32_t saved = xt_rsil(3);
+  outer.enter();
+  outer.exit();
+  CHECK_EQ(host::getInterruptLevel(), 3);
+  xt_wsr_ps(saved);
+  CHECK_EQ(host::getInterruptLevel(), 0);
+
+  printf("critical section ok\n");
+  return 0;
+}
@@ -0,0 +1,115 @@
+// CyclicExecutive frame dispatch, overruns and missed frames.
+
+#include "ReactESP.h"
+#include "cyclic_executive.h"
+#include "host.h"
+#include "host_test.h"
+
+using namespace reactesp;
+
+namespace {
+
+void runFor(EventLoop& loop, uint32_t us) {
+  for (uint32_t i = 0; i < us; i += 100) {
+    host::advance(100);
+    loop.tick();
+  }
+}
+
+void testFrames() {
+  EventLoop loop;
+  CyclicExecutive executive(&loop, 1000, 10);
+  int every = 0;
+  int second = 0;
+  int once = 0;
+  uint16_t once_frame = 0;
+  CHECK(executive.addTask([&]() { every++; }, 1));
+  CHECK(executive.addTask([&]() { second++; }, 2, 1));
+  CHECK(executive.addTask(
+      [&]() {
+        once++;
+        once_frame = executive.getCurrentFrame();
+      },
+      10, 5));
+  CHECK(!executive.addTask([]() {}, 3));
+  executive.start();
+  runFor(loop, 30000);
+  CHECK_EQ(executive.getFrameCount(), 30);
+  CHECK_EQ(every, 30);
+  CHECK_EQ(second, 15);
+  CHECK_EQ(once, 3);
+  CHECK_EQ(once_frame, 5);
+  CHECK_EQ(executive.getOverrunCount(), 0);
+  CHECK_EQ(executive.getMissedFrameCount(), 0);
+}
+
+void testOverrun() {
+  EventLoop loop;
+  CyclicExecutive executive(&loop, 1000, 4);
+  int overruns = 0;
+  uint16_t overrun_frame = 0;
+  executive.addToFrame(2, []() { host::advance(1500); });
+  executive.onOverrun([&](uint16_t frame, uint32_t duration_us) {
+    overruns++;
+    overrun_frame = frame;
+    CHECK(duration_us >= 1500);
+  });
+  executive.start();
+  runFor(loop, 3000);
+  CHECK_EQ(overruns, 1);
+  CHECK_EQ(overrun_frame, 2);
+  CHECK(executive.getMaxFrameDuration() >= 1500);
+}
+
+// Frames that could not start because the loop was blocked are skipped and
+// counted, and the frame index follows the time
+void testMissedFrames() {
+  EventLoop loop;
+  CyclicExecutive executive(&loop, 1000, 10);
+  int frame_runs[10] = {};
+  for (uint16_t f = 0; f < 10; f++) {
+    executive.addToFrame(f, [&frame_runs, f]() { frame_runs[f]++; });
+  }
+  executive.start();
+  runFor(loop, 2000);
+  CHECK_EQ(frame_runs[0], 1);
+  CHECK_EQ(frame_runs[1], 1);
+  // block the loop: frames 2 and 3 cannot start, frame 4 starts late
+  host::advance(3500);
+  loop.tick();
+  CHECK_EQ(executive.getMissedFrameCount(), 2);
+  CHECK_EQ(executive.getOverrunCount(), 2);
+  CHECK_EQ(frame_runs[2], 0);
+  CHECK_EQ(frame_runs[3], 0);
+  CHECK_EQ(frame_runs[4], 1);
+  CHECK_EQ(executive.getCurrentFrame(), 5);
+  CHECK_EQ(executive.getFrameCount(), 5);
+  // back in step
+  runFor(loop, 4000);
+  CHECK_EQ(executive.getMissedFrameCount(), 2);
+  CHECK_EQ(frame_runs[8], 1);
+  CHECK_EQ(executive.getFrameCount(), 9);
+}
+
+// Frame indices near the 16-bit limit
+void testLargeMajorFrame() {
+  EventLoop loop;
+  CyclicExecutive executive(&loop, 1, 65535);
+  int runs = 0;
+  CHECK(executive.addTask([&]() { runs++; }, 21845, 21844));
+  executive.start();
+  executive.stop();
+  CHECK_EQ(runs, 0);
+}
+
+}  // namespace
+
+int main() {
+  host::useManualClock(1000000);
+  testFrames();
+  testOverrun();
+  testMissedFrames();
+  testLargeMajorFrame();
+  printf("cyclic executive ok\n");
+  return 0;
+}
@@ -0,0 +1,176 @@
+// Dataflow stages: batch limits, backpressure and resume, and destroying
+// stages of a running pipeline.
+
+#include <memory>
+#include <vector>
+
+#include "ReactESP.h"
+#include "dataflow.h"
+#include "host_test.h"
+
+using namespace reactesp;
+
+namespace {
+
+// Sink that can refuse its input
+class GatedSink : public StageInput<int> {
+ public:
+  GatedSink(EventLoop* event_loop, size_t queue_size, size_t batch_size)
+      : StageInput<int>(event_loop, queue_size, batch_size) {}
+
+  bool open = false;
+  std::vector<int> received;
+
+ protected:
+  bool process(const int& item) override {
+    if (!open) {
+      return false;
+    }
+    received.push_back(item);
+    return true;
+  }
+};
+
+void testBatchLimit() {
+  EventLoop loop;
+  std::vector<int> received;
+  SinkStage<int> sink(&loop, 16, 3,
+                      [&](const int& item) { received.push_back(item); });
+  for (int i = 0; i < 10; i++) {
+    CHECK(sink.push(i));
+  }
+  loop.tick();
+  CHECK_EQ(received.size(), 3);
+  CHECK_EQ(sink.getQueueDepth(), 7);
+  for (int i = 0; i < 5; i++) {
+    loop.tick();
+  }
+  CHECK_EQ(received.size(), 10);
+  for (int i = 0; i < 10; i++) {
+    CHECK_EQ(received[i], i);
+  }
+  CHECK_EQ(sink.getStats().invocations, 4);
+  CHECK_EQ(sink.getStats().items_processed, 10);
+  CHECK_EQ(sink.getMaxQueueDepth(), 10);
+
+  // a full queue drops
+  SinkStage<int> small(&loop, 2, 1, [](const int& item) {});
+  CHECK(small.push(1));
+  CHECK(small.push(2));
+  CHECK(!small.push(3));
+  CHECK_EQ(small.getStats().items_dropped, 1);
+}
+
+// A stage stops when its downstream queue is full and continues once the
+// downstream stage has made progress
+void testBackpressure() {
+  EventLoop loop;
+  Stage<int, int> doubler(&loop, 16, 16, [](const int& in, int& out) {
+    out = 2 * in;
+    return true;
+  });
+  GatedSink sink(&loop, 2, 1);
+  doubler.connect(sink);
+  for (int i = 0; i < 8; i++) {
+    CHECK(doubler.push(i));
+  }
+  for (int i = 0; i < 5; i++) {
+    loop.tick();
+  }
+  // blocked: the sink refuses, and its queue is full
+  CHECK_EQ(sink.getQueueDepth(), 2);
+  CHECK_EQ(doubler.getQueueDepth(), 6);
+  CHECK_EQ(doubler.getStats().items_emitted, 2);
+  CHECK_EQ(sink.getStats().items_dropped, 0);
+
+  // nothing runs until resume() is called
+  sink.open = true;
+  loop.tick();
+  CHECK_EQ(sink.received.size(), 0);
+  sink.resume();
+  for (int i = 0; i < 20; i++) {
+    loop.tick();
+  }
+  CHECK_EQ(sink.received.size(), 8);
+  for (int i = 0; i < 8; i++) {
+    CHECK_EQ(sink.received[i], 2 * i);
+  }
+  CHECK_EQ(doubler.getQueueDepth(), 0);
+  CHECK_EQ(sink.getStats().items_dropped, 0);
+}
+
+// Filtering transforms emit nothing for some inputs
+void testFilter() {
+  EventLoop loop;
+  Stage<int, int> even(&loop, 8, 8, [](const int& in, int& out) {
+    out = in;
+    return in % 2 == 0;
+  });
+  std::vector<int> received;
+  SinkStage<int> sink(&loop, 8, 8,
+                      [&](const int& item) { received.push_back(item); });
+  even.connect(sink);
+  for (int i = 0; i < 6; i++) {
+    even.push(i);
+  }
+  for (int i = 0; i < 3; i++) {
+    loop.tick();
+  }
+  CHECK_EQ(received.size(), 3);
+  CHECK_EQ(even.getStats().items_processed, 6);
+  CHECK_EQ(even.getStats().items_emitted, 3);
+}
+
+// Destroying a stage disconnects it from the rest of the pipeline
+void testDestroyStages() {
+  EventLoop loop;
+  auto identity = [](const int& in, int& out) {
+    out = in;
+    return true;
+  };
+  Stage<int, int> source(&loop, 8, 8, identity);
+  std::vector<int> kept;
+  SinkStage<int> keep(&loop, 8, 8,
+                      [&](const int& item) { kept.push_back(item); });
+  std::unique_ptr<SinkStage<int>> dropped(
+      new SinkStage<int>(&loop, 8, 8, [](const int& item) {}));
+  source.connect(keep);
+  source.connect(*dropped);
+  source.push(1);
+  loop.tick();
+  loop.tick();
+  // the downstream stage goes first
+  dropped.reset();
+  source.push(2);
+  loop.tick();
+  loop.tick();
+  CHECK_EQ(kept.size(), 2);
+
+  // the upstream stage goes first; the sink no longer resumes it
+  std::unique_ptr<Stage<int, int>> upstream(
+      new Stage<int, int>(&loop, 8, 8, identity));
+  GatedSink sink(&loop, 1, 1);
+  upstream->connect(sink);
+  upstream->push(3);
+  upstream->push(4);
+  loop.tick();
+  loop.tick();
+  CHECK_EQ(sink.getQueueDepth(), 1);
+  upstream.reset();
+  sink.open = true;
+  sink.resume();
+  loop.tick();
+  loop.tick();
+  CHECK_EQ(sink.received.size(), 1);
+}
+
+}  // namespace
+
+int main() {
+  testBatchLimit();
+  testBackpressure();
+  testFilter();
+  testDestroyStages();
+  printf("dataflow ok\n");
+  return 0;
+}
@@ -0,0 +1,62 @@
+// DescriptorTableEvent scheduling, including across the wraparound of the
+// 32-bit millisecond deadlines.
+
+#include "ReactESP.h"
+#include "host.h"
+#include "host_test.h"
+
+using namespace reactesp;
+
+namespace {
+
+int fast_runs = 0;
+int slow_runs = 0;
+
+void fast() { fast_runs++; }
+void slow() { slow_runs++; }
+
+const char kSlowName[] = "slow";
+
+const EventDescriptor kTable[] = {
+    {10, fast, nullptr, 0},
+    {25, slow, kSlowName, REACTESP_DESCRIPTOR_RUN_AT_START},
+};
+
+// Run the loop for ms milliseconds in 1 ms steps and return the number of
+// times the table was dispatched
+uint64_t runFor(EventLoop& loop, int ms) {
+  const uint64_t before = loop.getTimedEventCount();
+  for (int i = 0; i < ms; i++) {
+    host::advance(1000);
+    loop.tick();
+  }
+  return loop.getTimedEventCount() - before;
+}
+
+void testSchedule(int64_t start_us) {
+  host::setTime(start_us);
+  fast_runs = 0;
+  slow_runs = 0;
+  EventLoop loop;
+  DescriptorTableEvent* table = loop.onDescriptorTable(kTable);
+  CHECK_EQ(table->find("slow"), 1);
+  CHECK_EQ(table->find("none"), -1);
+  const uint64_t dispatches = runFor(loop, 200);
+  CHECK_EQ(fast_runs, 20);
+  // at start, then every 25 ms
+  CHECK_EQ(slow_runs, 9);
+  // the table is only dispatched when an entry is due
+  CHECK(dispatches <= 29);
+  CHECK(table->getTriggerTimeMicros() > micros64());
+}
+
+}  // namespace
+
+int main() {
+  host::useManualClock(1000000);
+  testSchedule(1000000);
+  // 100 ms before the millisecond counter wraps around after 49.7 days
+  testSchedule(((int64_t)1 << 32) * 1000 - 100000);
+  printf("descriptor table ok\n");
+  return 0;
+}
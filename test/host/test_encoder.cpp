@@ -0,0 +1,172 @@
+// EncoderEvent decoding synthetic edge sequences on the simulated pins.
+
+#include <driver/gpio.h>
+
+#include "ReactESP.h"
+#include "host.h"
+#include "host_test.h"
+
+using namespace reactesp;
+
+namespace {
+
+const uint8_t kPinA = 16;
+const uint8_t kPinB = 17;
+
+struct Reports {
+  int calls = 0;
+  int32_t position = 0;
+  int32_t delta_sum = 0;
+
+  encoder_callback callback() {
+    return [this](int32_t position, int32_t delta) {
+      this->calls++;
+      this->position = position;
+      this->delta_sum += delta;
+    };
+  }
+};
+
+// Gray code sequence of (A, B) for forward rotation, A leading
+const int kForward[4][2] = {{1, 0}, {1, 1}, {0, 1}, {0, 0}};
+
+void resetPins() {
+  host::setPinLevel(kPinA, 0);
+  host::setPinLevel(kPinB, 0);
+}
+
+void step(const int levels[2]) {
+  if (digitalRead(kPinA) != levels[0]) {
+    host::setPinLevel(kPinA, levels[0]);
+  }
+  if (digitalRead(kPinB) != levels[1]) {
+    host::setPinLevel(kPinB, levels[1]);
+  }
+}
+
+void testForwardAndReverse() {
+  resetPins();
+  EventLoop loop;
+  Reports reports;
+  EncoderEvent* encoder = loop.onEncoder(kPinA, kPinB, reports.callback());
+  for (int cycle = 0; cycle < 2; cycle++) {
+    for (int i = 0; i < 4; i++) {
+      step(kForward[i]);
+    }
+  }
+  CHECK_EQ(encoder->getPosition(), 8);
+  loop.tick();
+  CHECK_EQ(reports.calls, 1);
+  CHECK_EQ(reports.position, 8);
+  CHECK_EQ(reports.delta_sum, 8);
+
+  // one full cycle backwards
+  for (int i = 2; i >= 0; i--) {
+    step(kForward[i]);
+  }
+  step(kForward[3]);
+  CHECK_EQ(encoder->getPosition(), 4);
+  loop.tick();
+  CHECK_EQ(reports.position, 4);
+  CHECK_EQ(reports.delta_sum, 4);
+  CHECK_EQ(encoder->getErrorCount(), 0);
+  encoder->remove(&loop);
+}
+
+// Reversing in the middle of a cycle and contact bounce on one channel
+void testDirectionReversal() {
+  resetPins();
+  EventLoop loop;
+  Reports reports;
+  EncoderEvent* encoder = loop.onEncoder(kPinA, kPinB, reports.callback());
+  step(kForward[0]);
+  step(kForward[1]);
+  CHECK_EQ(encoder->getPosition(), 2);
+  // back to where it started
+  step(kForward[0]);
+  step(kForward[3]);
+  CHECK_EQ(encoder->getPosition(), 0);
+  // and past it
+  step(kForward[2]);
+  CHECK_EQ(encoder->getPosition(), -1);
+
+  // A bouncing while B stays high: the steps cancel out
+  for (int i = 0; i < 5; i++) {
+    host::setPinLevel(kPinA, 1);
+    host::setPinLevel(kPinA, 0);
+  }
+  CHECK_EQ(encoder->getPosition(), -1);
+  CHECK_EQ(encoder->getErrorCount(), 0);
+  loop.tick();
+  // the net change is reported once
+  CHECK_EQ(reports.calls, 1);
+  CHECK_EQ(reports.position, -1);
+  CHECK_EQ(reports.delta_sum, -1);
+  encoder->remove(&loop);
+}
+
+// A missed edge shows up as a transition in which both pins changed. It is
+// counted as an error and does not move the position.
+void testInvalidTransition() {
+  resetPins();
+  EventLoop loop;
+  Reports reports;
+  EncoderEvent* encoder = loop.onEncoder(kPinA, kPinB, reports.callback());
+  step(kForward[0]);
+  CHECK_EQ(encoder->getPosition(), 1);
+  // the edge of B is missed
+  gpio_intr_disable(kPinB);
+  host::setPinLevel(kPinB, 1);
+  gpio_intr_enable(kPinB);
+  host::setPinLevel(kPinA, 0);
+  CHECK_EQ(encoder->getErrorCount(), 1);
+  CHECK_EQ(encoder->getPosition(), 1);
+  // decoding resumes from the new state
+  step(kForward[3]);
+  CHECK_EQ(encoder->getPosition(), 2);
+
+  // the same through update()
+  encoder->update(true, true);
+  CHECK_EQ(encoder->getErrorCount(), 2);
+  encoder->update(true, false);
+  CHECK_EQ(encoder->getPosition(), 1);
+  loop.tick();
+  CHECK_EQ(reports.position, 1);
+
+  encoder->setPosition(100);
+  loop.tick();
+  CHECK_EQ(reports.calls, 1);
+  encoder->remove(&loop);
+}
+
+// With a notify interval, the callback is called at most once per interval
+void testNotifyInterval() {
+  resetPins();
+  host::useManualClock(1000000);
+  EventLoop loop;
+  Reports reports;
+  EncoderEvent* encoder =
+      loop.onEncoder(kPinA, kPinB, reports.callback(), 10000);
+  for (int ms = 0; ms < 50; ms++) {
+    step(kForward[ms % 4]);
+    host::advance(1000);
+    loop.tick();
+  }
+  CHECK_EQ(encoder->getPosition(), 50);
+  CHECK(reports.calls >= 4);
+  CHECK(reports.calls <= 5);
+  CHECK_EQ(reports.delta_sum, reports.position);
+  encoder->remove(&loop);
+  host::useRealClock();
+}
+
+}  // namespace
+
+int main() {
+  testForwardAndReverse();
+  testDirectionReversal();
+  testInvalidTransition();
+  testNotifyInterval();
+  printf("encoder ok\n");
+  return 0;
+}
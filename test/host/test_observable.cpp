@@ -0,0 +1,94 @@
+// Observable notification from the event loop: coalescing of set() calls,
+// observer order and destruction with a notification pending.
+
+#include <vector>
+
+#include "ReactESP.h"
+#include "host_test.h"
+#include "observable.h"
+
+using namespace reactesp;
+
+namespace {
+
+void testSet() {
+  EventLoop loop;
+  Observable<int> value(&loop, 5);
+  std::vector<int> seen;
+  value.attach([&](const int& v) { seen.push_back(v); });
+  CHECK_EQ(value.get(), 5);
+
+  // no notification without a change
+  loop.tick();
+  CHECK(seen.empty());
+
+  // delivered by the loop, not by set()
+  value.set(1);
+  CHECK_EQ(value.get(), 1);
+  CHECK(seen.empty());
+  loop.tick();
+  CHECK_EQ(seen.size(), 1u);
+  CHECK_EQ(seen[0], 1);
+
+  // changes between ticks result in one notification of the latest value
+  value.set(2);
+  value.set(3);
+  value = 4;
+  loop.tick();
+  CHECK_EQ(seen.size(), 2u);
+  CHECK_EQ(seen[1], 4);
+  CHECK_EQ(value.getSetCount(), 4u);
+  CHECK_EQ(value.getNotifyCount(), 2u);
+
+  loop.tick();
+  CHECK_EQ(value.getNotifyCount(), 2u);
+}
+
+// Observers run in attach order; a set() from an observer is delivered on
+// the next tick
+void testObservers() {
+  EventLoop loop;
+  Observable<int> source(&loop);
+  Observable<int> doubled(&loop);
+  std::vector<int> order;
+  source.attach([&](const int& v) { order.push_back(1); });
+  source.attach([&](const int& v) {
+    order.push_back(2);
+    doubled.set(2 * v);
+  });
+  int result = 0;
+  doubled.attach([&](const int& v) { result = v; });
+
+  source.set(21);
+  loop.tick();
+  CHECK_EQ(order.size(), 2u);
+  CHECK_EQ(order[0], 1);
+  CHECK_EQ(order[1], 2);
+  CHECK_EQ(result, 0);
+  loop.tick();
+  CHECK_EQ(result, 42);
+  CHECK_EQ(doubled.getNotifyCount(), 1u);
+}
+
+void testDestroyPending() {
+  EventLoop loop;
+  int calls = 0;
+  {
+    Observable<int> value(&loop);
+    value.attach([&](const int& v) { calls++; });
+    value.set(1);
+  }
+  loop.tick();
+  loop.tick();
+  CHECK_EQ(calls, 0);
+}
+
+}  // namespace
+
+int main() {
+  testSet();
+  testObservers();
+  testDestroyPending();
+  printf("observable ok\n");
+  return 0;
+}
@@ -0,0 +1,182 @@
+// Subscription lifetime of the stream operators and the shared timers.
+
+#include "ReactESP.h"
+#include "host.h"
+#include "host_test.h"
+#include "operators.h"
+
+using namespace reactesp;
+
+namespace {
+
+void runFor(EventLoop& loop, uint32_t ms) {
+  for (uint32_t i = 0; i < ms; i++) {
+    host::advance(1000);
+    loop.tick();
+  }
+}
+
+void testOperatorsUnsubscribe() {
+  EventStream<int> source;
+  int mapped = 0;
+  int filtered = 0;
+  int distinct = 0;
+  int buffered = 0;
+  {
+    Map<int, int> map(source, [](const int& v) { return 2 * v; });
+    map.subscribe([&](const int& v) { mapped++; });
+    Filter<int> filter(source, [](const int& v) { return v > 0; });
+    filter.subscribe([&](const int& v) { filtered++; });
+    DistinctUntilChanged<int> changes(source);
+    changes.subscribe([&](const int& v) { distinct++; });
+    Buffer<int> buffer(source, 1);
+    buffer.subscribe([&](const std::vector<int>& v) { buffered++; });
+    source.emit(1);
+  }
+  CHECK_EQ(mapped, 1);
+  CHECK_EQ(filtered, 1);
+  CHECK_EQ(distinct, 1);
+  CHECK_EQ(buffered, 1);
+  // the destroyed operators are no longer called
+  source.emit(2);
+  CHECK_EQ(mapped, 1);
+  CHECK_EQ(filtered, 1);
+  CHECK_EQ(distinct, 1);
+  CHECK_EQ(buffered, 1);
+}
+
+void testUnsubscribeDuringEmit() {
+  EventStream<int> source;
+  int first = 0;
+  int second = 0;
+  int late = 0;
+  EventStream<int>::subscription_handle second_handle = 0;
+  source.subscribe([&](const int& v) {
+    first++;
+    if (first == 1) {
+      // remove the next subscriber and add a new one mid-emission
+      source.unsubscribe(second_handle);
+      source.subscribe([&](const int& v) { late++; });
+    }
+  });
+  second_handle = source.subscribe([&](const int& v) { second++; });
+  source.emit(1);
+  CHECK_EQ(first, 1);
+  CHECK_EQ(second, 0);
+  CHECK_EQ(late, 0);
+  source.emit(2);
+  CHECK_EQ(first, 2);
+  CHECK_EQ(second, 0);
+  CHECK_EQ(late, 1);
+
+  // a subscriber removing itself
+  EventStream<int> stream;
+  int once = 0;
+  EventStream<int>::subscription_handle self = 0;
+  self = stream.subscribe([&](const int& v) {
+    once++;
+    stream.unsubscribe(self);
+  });
+  stream.emit(1);
+  stream.emit(2);
+  CHECK_EQ(once, 1);
+}
+
+void testTimeOperatorsUnsubscribe() {
+  EventLoop loop;
+  SharedTimers timers(&loop);
+  EventStream<int> source;
+  int sampled = 0;
+  auto* sample = new Sample<int>(timers, source, 10);
+  sample->subscribe([&](const int& v) { sampled++; });
+  {
+    TimeWindow<int> window(timers, source, 10);
+    CHECK_EQ(timers.size(), 1);
+  }
+  CHECK_EQ(timers.size(), 1);
+  source.emit(1);
+  runFor(loop, 11);
+  CHECK_EQ(sampled, 1);
+  delete sample;
+  CHECK_EQ(timers.size(), 0);
+  source.emit(2);
+  runFor(loop, 30);
+  CHECK_EQ(sampled, 1);
+}
+
+// An operator that deletes itself on its first period
+class OneShot : public TimedOperator {
+ public:
+  OneShot(SharedTimers& timers, int& count) : timers(timers), count(count) {
+    timers.subscribe(10, this);
+  }
+  ~OneShot() { timers.unsubscribe(this); }
+
+  void onPeriod() override {
+    count++;
+    delete this;
+  }
+
+ private:
+  SharedTimers& timers;
+  int& count;
+};
+
+// Operators removed and added from within onPeriod()
+void testSharedTimersChangesDuringDispatch() {
+  EventLoop loop;
+  SharedTimers timers(&loop);
+  EventStream<int> source;
+  int a_count = 0;
+  int b_count = 0;
+  int c_count = 0;
+  int d_count = 0;
+  int one_shot_count = 0;
+  Sample<int>* b = new Sample<int>(timers, source, 10);
+  Sample<int>* a = new Sample<int>(timers, source, 10);
+  new OneShot(timers, one_shot_count);
+  Sample<int> d(timers, source, 10);
+  Sample<int>* c = nullptr;
+  b->subscribe([&](const int& v) { b_count++; });
+  d.subscribe([&](const int& v) { d_count++; });
+  a->subscribe([&](const int& v) {
+    a_count++;
+    if (a_count == 1) {
+      // delete an operator that has already run and add one with a new
+      // period
+      delete b;
+      b = nullptr;
+      c = new Sample<int>(timers, source, 5);
+      c->subscribe([&](const int& v) { c_count++; });
+    }
+  });
+  source.emit(1);
+  runFor(loop, 10);
+  CHECK_EQ(a_count, 1);
+  CHECK_EQ(b_count, 1);
+  CHECK_EQ(one_shot_count, 1);
+  CHECK_EQ(d_count, 1);
+  CHECK_EQ(timers.size(), 2);
+  source.emit(2);
+  runFor(loop, 10);
+  CHECK_EQ(a_count, 2);
+  CHECK_EQ(b_count, 1);
+  CHECK_EQ(one_shot_count, 1);
+  CHECK_EQ(d_count, 2);
+  CHECK(c_count >= 1);
+  delete a;
+  delete c;
+  CHECK_EQ(timers.size(), 1);
+}
+
+}  // namespace
+
+int main() {
+  host::useManualClock(1000);
+  testOperatorsUnsubscribe();
+  testUnsubscribeDuringEmit();
+  testTimeOperatorsUnsubscribe();
+  testSharedTimersChangesDuringDispatch();
+  printf("operators ok\n");
+  return 0;
+}
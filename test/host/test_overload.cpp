@@ -0,0 +1,206 @@
+// Overload detection from utilization and lateness, and load shedding
+// while the loop is overloaded.
+
+#include <vector>
+
+#include "ReactESP.h"
+#include "host.h"
+#include "host_test.h"
+
+using namespace reactesp;
+
+namespace {
+
+const EventDescriptor kTable[] = {
+    {10, []() {}, nullptr, REACTESP_DESCRIPTOR_RUN_AT_START},
+};
+
+// Records the state passed to each overload callback
+struct Transitions {
+  std::vector<bool> states;
+
+  overload_callback callback() {
+    return [this](const LoadStats& stats) {
+      this->states.push_back(stats.overloaded);
+    };
+  }
+};
+
+// Enter overload above the high threshold and leave it only below the low
+// one
+void testUtilization() {
+  EventLoop loop;
+  uint64_t work_us = 600;
+  TriggeredEvent* work = loop.onTrigger([&]() { host::advance(work_us); });
+  Transitions transitions;
+  loop.onOverloadChange(transitions.callback());
+  loop.enableOverloadDetection(10, 50, 20);
+
+  // untimed events alone do not make the ticks busy, however long they
+  // take
+  int untimed_runs = 0;
+  TickEvent* untimed = loop.onTick([&]() {
+    untimed_runs++;
+    host::advance(800);
+  });
+  for (int i = 0; i < 20; i++) {
+    host::advance(200);
+    loop.tick();
+  }
+  CHECK(untimed_runs > 0);
+  untimed->remove(&loop);
+  CHECK(!loop.isOverloaded());
+  CHECK(loop.getLoadStats().utilization_percent < 5);
+
+  // 1 ms ticks, each dispatching an event that takes work_us of the
+  // millisecond
+  auto step = [&](int ticks) {
+    for (int i = 0; i < ticks; i++) {
+      host::advance(1000 - work_us);
+      work->trigger();
+      loop.tick();
+    }
+  };
+  step(20);
+  CHECK(loop.isOverloaded());
+  CHECK(loop.getLoadStats().utilization_percent >= 58);
+  CHECK(loop.getLoadStats().utilization_percent <= 62);
+  CHECK_EQ(transitions.states.size(), 1);
+  CHECK(transitions.states[0]);
+
+  // between the thresholds: stays overloaded
+  work_us = 300;
+  step(30);
+  CHECK(loop.isOverloaded());
+  CHECK(loop.getLoadStats().utilization_percent >= 28);
+  CHECK(loop.getLoadStats().utilization_percent <= 32);
+  CHECK_EQ(transitions.states.size(), 1);
+
+  // below the low threshold: recovers
+  work_us = 100;
+  step(30);
+  CHECK(!loop.isOverloaded());
+  CHECK_EQ(transitions.states.size(), 2);
+  CHECK(!transitions.states[1]);
+
+  // and back
+  work_us = 900;
+  step(30);
+  CHECK(loop.isOverloaded());
+  CHECK_EQ(transitions.states.size(), 3);
+  CHECK_EQ(loop.getLoadStats().overload_count, 2);
+}
+
+// Enter overload when timed events run late, and leave it once the
+// lateness has dropped to half of the threshold
+void testLateness() {
+  EventLoop loop;
+  loop.onRepeat(2, []() {});
+  Transitions transitions;
+  loop.onOverloadChange(transitions.callback());
+  // utilization alone never overloads
+  loop.enableOverloadDetection(10, 255, 255, 500);
+
+  // ticks every 5 ms: each run is 3 ms late
+  for (int i = 0; i < 8; i++) {
+    host::advance(5000);
+    loop.tick();
+  }
+  CHECK(loop.isOverloaded());
+  CHECK_EQ(loop.getLoadStats().average_lateness, 3000);
+  CHECK_EQ(transitions.states.size(), 1);
+
+  // 400 us late: below the threshold, but not below half of it
+  host::advance(2400);
+  loop.tick();
+  for (int i = 0; i < 12; i++) {
+    host::advance(2000);
+    loop.tick();
+  }
+  CHECK(loop.isOverloaded());
+  CHECK_EQ(loop.getLoadStats().average_lateness, 400);
+
+  // on time
+  host::advance(1600);
+  loop.tick();
+  for (int i = 0; i < 12; i++) {
+    host::advance(2000);
+    loop.tick();
+  }
+  CHECK(!loop.isOverloaded());
+  CHECK_EQ(loop.getLoadStats().average_lateness, 0);
+  CHECK_EQ(transitions.states.size(), 2);
+}
+
+// Enter the overloaded state and stay there
+void overload(EventLoop& loop) {
+  loop.enableOverloadDetection(1, 0, 0);
+  host::advance(2000);
+  loop.tick();
+  CHECK(loop.isOverloaded());
+}
+
+void testShedDivisor() {
+  EventLoop loop;
+  int runs = 0;
+  RepeatEvent* event = loop.onRepeat(10, [&]() { runs++; });
+  event->setSheddable(true);
+  overload(loop);
+  for (int i = 0; i < 100; i++) {
+    host::advance(1000);
+    loop.tick();
+  }
+  // every other occurrence out of ten
+  CHECK_EQ(runs, 5);
+  CHECK_EQ(loop.getLoadStats().shed_count, 5);
+}
+
+// Skipping every occurrence of a zero-interval event must not keep the
+// tick busy
+void testZeroIntervalSkipAll() {
+  EventLoop loop;
+  loop.setShedDivisor(0);
+  overload(loop);
+  int runs = 0;
+  loop.onRepeatMicros((uint64_t)0, [&]() { runs++; })->setSheddable(true);
+  loop.onDescriptorTable(kTable)->setSheddable(true);
+  const uint64_t shed_before = loop.getLoadStats().shed_count;
+  for (int i = 0; i < 10; i++) {
+    host::advance(1000);
+    loop.tick();
+  }
+  CHECK_EQ(runs, 0);
+  // both events are skipped once per tick
+  CHECK_EQ(loop.getLoadStats().shed_count - shed_before, 20);
+}
+
+// With a divisor, the zero-interval event runs on some ticks. The clock
+// moves on every read, as on hardware.
+void testZeroIntervalDivisor() {
+  host::setAutoAdvance(1);
+  EventLoop loop;
+  int runs = 0;
+  loop.onRepeatMicros((uint64_t)0, [&]() { runs++; })->setSheddable(true);
+  overload(loop);
+  const int runs_before = runs;
+  for (int i = 0; i < 10; i++) {
+    host::advance(1000);
+    loop.tick();
+  }
+  CHECK(runs > runs_before);
+  CHECK(loop.getLoadStats().shed_count > 0);
+  host::setAutoAdvance(0);
+}
+
+}  // namespace
+
+int main() {
+  host::useManualClock(1000000);
+  testUtilization();
+  testLateness();
+  testShedDivisor();
+  testZeroIntervalSkipAll();
+  testZeroIntervalDivisor();
+  printf("overload ok\n");
+  return 0;
+}
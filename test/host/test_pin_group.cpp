@@ -0,0 +1,237 @@
+// PinGroupEvent on the shared GPIO interrupt handler and, when the GPIO ISR
+// service is in use, on per-pin handlers; per-pin events served by the
+// shared handler; callbacks that add pins or remove the group.
+
+#include <soc/gpio_struct.h>
+
+#include "ReactESP.h"
+#include "host.h"
+#include "host_test.h"
+
+using namespace reactesp;
+
+namespace {
+
+struct Calls {
+  int count[40] = {};
+  uint64_t timestamp[40] = {};
+
+  pin_group_callback callback() {
+    return [this](uint8_t pin, uint64_t timestamp) {
+      this->count[pin]++;
+      this->timestamp[pin] = timestamp;
+    };
+  }
+};
+
+// One interrupt per edge, status registers cleared, one callback per
+// changed pin per tick
+void testSharedHandler() {
+  EventLoop loop;
+  Calls calls;
+  PinGroupEvent* group = loop.onPinGroup();
+  group->addPin(4, CHANGE, calls.callback());
+  group->addPin(5, RISING, calls.callback());
+  group->addPin(35, CHANGE, calls.callback());
+
+  const uint32_t interrupts = host::getGpioInterruptCount();
+  host::setTime(2000000);
+  host::setPinLevel(4, 1);
+  host::setTime(2000100);
+  host::setPinLevel(4, 0);
+  host::setPinLevel(35, 1);
+  // falling edge on a RISING pin
+  host::setPinLevel(5, 1);
+  host::setPinLevel(5, 0);
+  CHECK_EQ(host::getGpioInterruptCount() - interrupts, 4);
+  CHECK_EQ(GPIO.status, 0);
+  CHECK_EQ(GPIO.status1.intr_st, 0);
+
+  loop.tick();
+  CHECK_EQ(calls.count[4], 1);
+  CHECK_EQ(calls.count[5], 1);
+  CHECK_EQ(calls.count[35], 1);
+  // the time of the first change of the group
+  CHECK_EQ(calls.timestamp[4], 2000000);
+  CHECK_EQ(calls.timestamp[35], 2000000);
+  loop.tick();
+  CHECK_EQ(calls.count[4], 1);
+
+  // pins outside the group are ignored, and their status is left alone
+  host::raiseGpioInterrupt((uint64_t)1 << 6);
+  loop.tick();
+  CHECK_EQ(calls.count[6], 0);
+  CHECK_EQ(GPIO.status, (uint32_t)1 << 6);
+  GPIO.status = 0;
+
+  group->remove(&loop);
+  loop.tick();
+  host::setPinLevel(4, 1);
+  loop.tick();
+  CHECK_EQ(calls.count[4], 1);
+  host::setPinLevel(4, 0);
+}
+
+// Groups share the handler, which reads the status once per interrupt
+void testTwoGroups() {
+  EventLoop loop;
+  Calls calls;
+  PinGroupEvent* first = loop.onPinGroup();
+  PinGroupEvent* second = loop.onPinGroup();
+  first->addPin(12, RISING, calls.callback());
+  second->addPin(13, RISING, calls.callback());
+  second->addPin(33, RISING, calls.callback());
+
+  const uint32_t interrupts = host::getGpioInterruptCount();
+  host::raiseGpioInterrupt(((uint64_t)1 << 12) | ((uint64_t)1 << 13) |
+                           ((uint64_t)1 << 33));
+  CHECK_EQ(host::getGpioInterruptCount() - interrupts, 1);
+  loop.tick();
+  CHECK_EQ(calls.count[12], 1);
+  CHECK_EQ(calls.count[13], 1);
+  CHECK_EQ(calls.count[33], 1);
+
+  first->remove(&loop);
+  host::raiseGpioInterrupt(((uint64_t)1 << 12) | ((uint64_t)1 << 13));
+  loop.tick();
+  CHECK_EQ(calls.count[12], 1);
+  CHECK_EQ(calls.count[13], 2);
+  // pin 12 is no longer served
+  CHECK_EQ(GPIO.status, (uint32_t)1 << 12);
+  GPIO.status = 0;
+  second->remove(&loop);
+  loop.tick();
+}
+
+// Callbacks that add pins and remove the group during the dispatch
+void testCallbacksChangingGroup() {
+  EventLoop loop;
+  Calls calls;
+  PinGroupEvent* group = loop.onPinGroup();
+  int added = 0;
+  group->addPin(2, RISING, [&](uint8_t pin, uint64_t timestamp) {
+    calls.count[pin]++;
+    // enough pins to reallocate the pin list
+    for (int i = 0; i < 16; i++) {
+      group->addPin(3, RISING, calls.callback());
+      added++;
+    }
+  });
+  group->addPin(14, RISING, calls.callback());
+  host::raiseGpioInterrupt(((uint64_t)1 << 2) | ((uint64_t)1 << 3) |
+                           ((uint64_t)1 << 14));
+  loop.tick();
+  CHECK_EQ(calls.count[2], 1);
+  CHECK_EQ(calls.count[14], 1);
+  // added during the dispatch: not called until the next one
+  CHECK_EQ(calls.count[3], 0);
+  host::raiseGpioInterrupt((uint64_t)1 << 3);
+  loop.tick();
+  CHECK_EQ(calls.count[3], added);
+
+  PinGroupEvent* removed = loop.onPinGroup();
+  removed->addPin(15, RISING, [&](uint8_t pin, uint64_t timestamp) {
+    calls.count[pin]++;
+    removed->remove(&loop);
+  });
+  removed->addPin(16, RISING, calls.callback());
+  host::raiseGpioInterrupt(((uint64_t)1 << 15) | ((uint64_t)1 << 16));
+  loop.tick();
+  CHECK_EQ(calls.count[15], 1);
+  CHECK_EQ(calls.count[16], 0);
+  loop.tick();
+  group->remove(&loop);
+  loop.tick();
+}
+
+// Interrupt and encoder events added while a group owns the GPIO interrupt
+// are served by the shared handler, which stays installed until they are
+// removed as well
+void testPinsOnSharedHandler() {
+  EventLoop loop;
+  Calls calls;
+  PinGroupEvent* group = loop.onPinGroup();
+  group->addPin(23, RISING, calls.callback());
+  int isr_calls = 0;
+  ISREvent* isr = loop.onInterrupt(24, RISING, [&]() { isr_calls++; });
+  int32_t position = 0;
+  EncoderEvent* encoder = loop.onEncoder(
+      25, 26, [&](int32_t new_position, int32_t delta) {
+        position = new_position;
+      });
+
+  host::setPinLevel(23, 1);
+  host::setPinLevel(24, 1);
+  host::setPinLevel(25, 1);
+  host::setPinLevel(26, 1);
+  loop.tick();
+  CHECK_EQ(calls.count[23], 1);
+  CHECK_EQ(isr_calls, 1);
+  CHECK_EQ(position, 2);
+  CHECK_EQ(GPIO.status, 0);
+
+  group->remove(&loop);
+  loop.tick();
+  host::setPinLevel(24, 0);
+  host::setPinLevel(24, 1);
+  host::setPinLevel(25, 0);
+  loop.tick();
+  CHECK_EQ(isr_calls, 2);
+  CHECK_EQ(position, 3);
+
+  isr->remove(&loop);
+  encoder->remove(&loop);
+  loop.tick();
+  host::setPinLevel(24, 0);
+  host::setPinLevel(24, 1);
+  CHECK_EQ(isr_calls, 2);
+  host::setPinLevel(23, 0);
+  host::setPinLevel(25, 0);
+  host::setPinLevel(26, 0);
+  host::setPinLevel(24, 0);
+
+  // with the shared handler freed, the GPIO ISR service can be installed
+  ISREvent* after = loop.onInterrupt(24, RISING, [&]() { isr_calls++; });
+  host::setPinLevel(24, 1);
+  CHECK_EQ(isr_calls, 3);
+  after->remove(&loop);
+  host::setPinLevel(24, 0);
+}
+
+// With the GPIO ISR service installed, a group attaches per-pin handlers
+void testIsrServiceFallback() {
+  EventLoop loop;
+  int isr_calls = 0;
+  loop.onInterrupt(20, RISING, [&]() { isr_calls++; });
+  Calls calls;
+  PinGroupEvent* group = loop.onPinGroup();
+  group->addPin(21, CHANGE, calls.callback());
+  group->addPin(22, CHANGE, calls.callback());
+
+  host::setPinLevel(20, 1);
+  host::setPinLevel(21, 1);
+  host::setPinLevel(22, 1);
+  loop.tick();
+  CHECK_EQ(isr_calls, 1);
+  CHECK_EQ(calls.count[21], 1);
+  CHECK_EQ(calls.count[22], 1);
+  group->remove(&loop);
+  loop.tick();
+  host::setPinLevel(21, 0);
+  loop.tick();
+  CHECK_EQ(calls.count[21], 1);
+}
+
+}  // namespace
+
+int main() {
+  host::useManualClock(1000000);
+  testSharedHandler();
+  testTwoGroups();
+  testCallbacksChangingGroup();
+  // installs the GPIO ISR service, which stays installed
+  testPinsOnSharedHandler();
+  testIsrServiceFallback();
+  printf("pin group ok\n");
+  return 0;
+}
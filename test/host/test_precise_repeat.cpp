@@ -0,0 +1,110 @@
+// PreciseRepeatEvent dispatch by esp_timer and its removal while a
+// callback is running.
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+
+#include "ReactESP.h"
+#include "host.h"
+#include "host_test.h"
+
+using namespace reactesp;
+
+namespace {
+
+// Sets a flag when the last copy of the callback is destroyed
+struct Guard {
+  explicit Guard(std::atomic<bool>& destroyed) : destroyed(destroyed) {}
+  ~Guard() { destroyed = true; }
+  std::atomic<bool>& destroyed;
+};
+
+void sleepMs(int ms) {
+  std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+// The callbacks run without the loop being ticked
+void testDispatch() {
+  EventLoop loop;
+  std::atomic<int> calls{0};
+  PreciseRepeatEvent* event =
+      loop.onPreciseRepeatMicros((uint64_t)2000, [&]() { calls++; });
+  sleepMs(60);
+  const int seen = calls.load();
+  CHECK(seen >= 10);
+  const LatenessStats stats = event->getLatenessStats();
+  CHECK(stats.count >= (uint32_t)seen);
+  CHECK(stats.count <= (uint32_t)seen + 1);
+  event->remove(&loop);
+  host::waitForTimers();
+  const int after_remove = calls.load();
+  sleepMs(20);
+  CHECK_EQ(calls.load(), after_remove);
+}
+
+// remove() from the loop while the callback is running frees the event
+// only after the callback has returned
+void testRemoveDuringDispatch() {
+  EventLoop loop;
+  std::atomic<bool> destroyed{false};
+  std::atomic<bool> in_callback{false};
+  std::atomic<bool> destroyed_during_callback{false};
+  std::atomic<int> calls{0};
+  auto guard = std::make_shared<Guard>(destroyed);
+  PreciseRepeatEvent* event =
+      loop.onPreciseRepeatMicros((uint64_t)1000, [&, guard]() {
+        if (calls++ > 0) {
+          return;
+        }
+        in_callback = true;
+        sleepMs(30);
+        destroyed_during_callback = destroyed.load();
+      });
+  guard.reset();
+  while (!in_callback) {
+    std::this_thread::yield();
+  }
+  event->remove(&loop);
+  host::waitForTimers();
+  CHECK(!destroyed_during_callback);
+  CHECK(destroyed);
+  CHECK_EQ(calls.load(), 1);
+}
+
+// A callback removing its own event
+void testRemoveFromCallback() {
+  EventLoop loop;
+  std::atomic<bool> destroyed{false};
+  std::atomic<int> calls{0};
+  auto guard = std::make_shared<Guard>(destroyed);
+  PreciseRepeatEvent* event = nullptr;
+  std::atomic<bool> created{false};
+  event = loop.onPreciseRepeatMicros((uint64_t)1000, [&, guard]() {
+    while (!created) {
+      std::this_thread::yield();
+    }
+    if (++calls == 3) {
+      event->remove(&loop);
+    }
+  });
+  created = true;
+  guard.reset();
+  while (!destroyed) {
+    sleepMs(1);
+  }
+  host::waitForTimers();
+  sleepMs(10);
+  CHECK_EQ(calls.load(), 3);
+}
+
+}  // namespace
+
+int main() {
+  testDispatch();
+  testRemoveDuringDispatch();
+  testRemoveFromCallback();
+  printf("precise repeat ok\n");
+  return 0;
+}
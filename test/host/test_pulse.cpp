@@ -0,0 +1,139 @@
+// PulseEvent statistics from simulated edges and pin interrupts, and its
+// removal while the pin keeps toggling.
+
+#include <atomic>
+#include <thread>
+
+#include "ReactESP.h"
+#include "host.h"
+#include "host_test.h"
+
+using namespace reactesp;
+
+namespace {
+
+const uint8_t kPin = 18;
+
+struct Windows {
+  int calls = 0;
+  PulseStats last;
+
+  pulse_callback callback() {
+    return [this](const PulseStats& stats) {
+      this->calls++;
+      this->last = stats;
+    };
+  }
+};
+
+// 1 kHz with a 25 % duty cycle, fed through edge()
+void testSimulatedEdges() {
+  host::useManualClock(1000000);
+  EventLoop loop;
+  Windows windows;
+  PulseEvent* pulse = loop.onPulse(kPin, 100, windows.callback());
+  for (int i = 0; i <= 50; i++) {
+    const uint64_t rising = 2000000 + (uint64_t)i * 1000;
+    pulse->edge(true, rising);
+    pulse->edge(false, rising + 250);
+  }
+  host::advance(100000);
+  loop.tick();
+  CHECK_EQ(windows.calls, 1);
+  CHECK_EQ(windows.last.period_count, 50);
+  CHECK_EQ(windows.last.min_period_us, 1000);
+  CHECK_EQ(windows.last.max_period_us, 1000);
+  CHECK(windows.last.frequency > 999.9f && windows.last.frequency < 1000.1f);
+  CHECK(windows.last.average_width_us > 249.9f &&
+        windows.last.average_width_us < 250.1f);
+  CHECK(windows.last.duty_cycle > 0.2499f && windows.last.duty_cycle < 0.2501f);
+
+  // the statistics are reset for every window; the first period spans the
+  // window boundary
+  pulse->edge(true, 2100000);
+  pulse->edge(true, 2102000);
+  host::advance(100000);
+  loop.tick();
+  CHECK_EQ(windows.calls, 2);
+  CHECK_EQ(windows.last.period_count, 2);
+  CHECK_EQ(windows.last.min_period_us, 2000);
+  CHECK_EQ(windows.last.max_period_us, 50000);
+  CHECK(windows.last.average_width_us == 0);
+  host::advance(100000);
+  loop.tick();
+  CHECK_EQ(windows.calls, 3);
+  CHECK_EQ(windows.last.period_count, 0);
+  CHECK(windows.last.frequency == 0);
+
+  pulse->remove(&loop);
+  host::advance(100000);
+  loop.tick();
+  CHECK_EQ(windows.calls, 3);
+  host::useRealClock();
+}
+
+// Edges through the pin interrupt, rising edges only
+void testPinInterrupts() {
+  host::useManualClock(1000000);
+  host::setPinLevel(kPin, 0);
+  EventLoop loop;
+  Windows windows;
+  PulseEvent* pulse = loop.onPulse(kPin, 50, windows.callback(), false);
+  for (int i = 0; i < 10; i++) {
+    host::setPinLevel(kPin, 1);
+    host::advance(100);
+    host::setPinLevel(kPin, 0);
+    host::advance(400);
+  }
+  host::advance(50000 - 5000);
+  loop.tick();
+  CHECK_EQ(windows.calls, 1);
+  CHECK_EQ(windows.last.period_count, 9);
+  CHECK_EQ(windows.last.min_period_us, 500);
+  CHECK(windows.last.average_width_us == 0);
+
+  // edges after removal reach no handler
+  pulse->remove(&loop);
+  host::setPinLevel(kPin, 1);
+  host::setPinLevel(kPin, 0);
+  host::advance(50000);
+  loop.tick();
+  CHECK_EQ(windows.calls, 1);
+  host::useRealClock();
+}
+
+// Events removed while another thread keeps raising pin interrupts. An
+// interrupt taken while the event is being destroyed would run the base
+// ISREvent handler, whose callback is empty.
+void testRemoveWhileToggling() {
+  host::setPinLevel(kPin, 0);
+  EventLoop loop;
+  std::atomic<bool> stop{false};
+  std::thread toggler([&stop]() {
+    int level = 0;
+    while (!stop) {
+      level = !level;
+      host::setPinLevel(kPin, level);
+    }
+  });
+  int calls = 0;
+  for (int i = 0; i < 2000; i++) {
+    PulseEvent* pulse = loop.onPulse(
+        kPin, 1, [&calls](const PulseStats& stats) { calls++; });
+    std::this_thread::yield();
+    pulse->remove(&loop);
+  }
+  stop = true;
+  toggler.join();
+  loop.tick();
+}
+
+}  // namespace
+
+int main() {
+  testSimulatedEdges();
+  testPinInterrupts();
+  testRemoveWhileToggling();
+  printf("pulse ok\n");
+  return 0;
+}
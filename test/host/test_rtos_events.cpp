@@ -0,0 +1,165 @@
+// FreeRTOS queue, semaphore and event bits events.
+
+#include <freertos/event_groups.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "ReactESP.h"
+#include "host.h"
+#include "host_test.h"
+
+using namespace reactesp;
+
+namespace {
+
+void testQueueOncePerItem() {
+  EventLoop loop;
+  QueueHandle_t queue = xQueueCreate(4, sizeof(int));
+  int calls = 0;
+  int sum = 0;
+  loop.onQueue(queue, [&]() {
+    calls++;
+    int value;
+    if (xQueueReceive(queue, &value, 0) == pdTRUE) {
+      sum += value;
+    }
+  });
+  loop.tick();
+  CHECK_EQ(calls, 0);
+  for (int i = 1; i <= 3; i++) {
+    xQueueSend(queue, &i, 0);
+  }
+  loop.tick();
+  CHECK_EQ(calls, 3);
+  CHECK_EQ(sum, 6);
+  loop.tick();
+  CHECK_EQ(calls, 3);
+}
+
+// A callback that leaves the item in the queue is not called again until
+// a new item arrives.
+void testQueueNotDrained() {
+  EventLoop loop;
+  QueueHandle_t queue = xQueueCreate(4, sizeof(int));
+  int calls = 0;
+  loop.onQueue(queue, [&]() { calls++; });
+  const int value = 1;
+  xQueueSend(queue, &value, 0);
+  for (int i = 0; i < 10; i++) {
+    loop.tick();
+  }
+  CHECK_EQ(calls, 1);
+  xQueueSend(queue, &value, 0);
+  loop.tick();
+  CHECK_EQ(calls, 2);
+}
+
+void testSemaphoreOncePerGive() {
+  EventLoop loop;
+  SemaphoreHandle_t semaphore = xSemaphoreCreateCounting(8, 0);
+  int calls = 0;
+  loop.onSemaphore(semaphore, [&]() { calls++; });
+  xSemaphoreGive(semaphore);
+  xSemaphoreGive(semaphore);
+  loop.tick();
+  CHECK_EQ(calls, 2);
+  loop.tick();
+  CHECK_EQ(calls, 2);
+  CHECK_EQ(uxQueueMessagesWaiting(semaphore), 0);
+}
+
+void testEventBits() {
+  EventLoop loop;
+  EventGroupHandle_t group = xEventGroupCreate();
+  EventBits_t seen = 0;
+  loop.onEventBits(group, 0x06, [&](EventBits_t bits) { seen |= bits; });
+  xEventGroupSetBits(group, 0x03);
+  loop.tick();
+  CHECK_EQ(seen, 0x02);
+  CHECK_EQ(xEventGroupGetBits(group), 0x01);
+}
+
+// Filling every queue in the set to capacity between ticks must not
+// overflow the set.
+void testQueueSetCapacity() {
+  EventLoop loop;
+  const int kQueues = (REACTESP_QUEUE_SET_LENGTH - 1) / 4;
+  std::vector<QueueHandle_t> queues;
+  int received = 0;
+  for (int i = 0; i < kQueues; i++) {
+    QueueHandle_t queue = xQueueCreate(4, sizeof(int));
+    queues.push_back(queue);
+    loop.onQueue(queue, [queue, &received]() {
+      int value;
+      if (xQueueReceive(queue, &value, 0) == pdTRUE) {
+        received++;
+      }
+    });
+  }
+  // this one does not fit and is polled
+  QueueHandle_t polled = xQueueCreate(4, sizeof(int));
+  int polled_received = 0;
+  loop.onQueue(polled, [&]() {
+    int value;
+    if (xQueueReceive(polled, &value, 0) == pdTRUE) {
+      polled_received++;
+    }
+  });
+  for (int round = 0; round < 3; round++) {
+    for (QueueHandle_t queue : queues) {
+      for (int i = 0; i < 4; i++) {
+        CHECK(xQueueSend(queue, &i, 0) == pdTRUE);
+      }
+    }
+    xQueueSend(polled, &round, 0);
+    loop.tick();
+  }
+  CHECK_EQ(received, 3 * 4 * kQueues);
+  CHECK_EQ(polled_received, 3);
+}
+
+// tickBlocking() sleeps until another task sends an item
+void testBlockingWake() {
+  EventLoop loop;
+  QueueHandle_t queue = xQueueCreate(4, sizeof(int));
+  int received = 0;
+  loop.onQueue(queue, [&]() {
+    int value;
+    if (xQueueReceive(queue, &value, 0) == pdTRUE) {
+      received++;
+    }
+  });
+  std::thread producer([queue]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    const int value = 1;
+    xQueueSend(queue, &value, 0);
+  });
+  const auto start = std::chrono::steady_clock::now();
+  const uint64_t ticks_before = loop.getTickCount();
+  while (received == 0) {
+    loop.tickBlocking(2000);
+  }
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+  producer.join();
+  CHECK_EQ(received, 1);
+  // woke up on the send, without spinning
+  CHECK(elapsed < std::chrono::milliseconds(1000));
+  CHECK(loop.getTickCount() - ticks_before <= 2);
+}
+
+}  // namespace
+
+int main() {
+  testQueueOncePerItem();
+  testQueueNotDrained();
+  testSemaphoreOncePerGive();
+  testEventBits();
+  testQueueSetCapacity();
+  testBlockingWake();
+  printf("rtos events ok\n");
+  return 0;
+}
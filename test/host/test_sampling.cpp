@@ -0,0 +1,144 @@
+// SamplingEvent batch delivery, buffer handoff to the consumer, drops and
+// decimation, with the sampler run by esp_timer on a manual clock.
+
+#include <vector>
+
+#include "ReactESP.h"
+#include "host.h"
+#include "host_test.h"
+
+using namespace reactesp;
+
+namespace {
+
+// Take `count` samples at the 1 ms sampling interval
+void sampleFor(int count) {
+  for (int i = 0; i < count; i++) {
+    host::advance(1000);
+    host::waitForTimers();
+  }
+}
+
+void testBatches() {
+  host::useManualClock(1000000);
+  EventLoop loop;
+  int next = 0;
+  std::vector<int> received;
+  int calls = 0;
+  SamplingEvent<int>* event = loop.onSamplingMicros<int>(
+      1000, [&]() { return next++; }, 10,
+      [&](const int* samples, size_t count) {
+        CHECK_EQ(count, 10u);
+        received.insert(received.end(), samples, samples + count);
+        calls++;
+      });
+  for (int i = 0; i < 35; i++) {
+    sampleFor(1);
+    loop.tick();
+  }
+  CHECK_EQ(event->getSampleCount(), 35u);
+  CHECK_EQ(calls, 3);
+  CHECK_EQ(received.size(), 30u);
+  for (size_t i = 0; i < received.size(); i++) {
+    CHECK_EQ(received[i], (int)i);
+  }
+  CHECK_EQ(event->getDroppedCount(), 0u);
+  event->remove(&loop);
+  host::waitForTimers();
+  loop.tick();
+}
+
+// A consumer that falls behind gets the full batches in order, and the
+// batches are reused once they have been handed back
+void testHandoff() {
+  host::useManualClock(1000000);
+  EventLoop loop;
+  int next = 0;
+  std::vector<int> received;
+  const int* last_batch = nullptr;
+  std::vector<const int*> batches;
+  auto* event = new SamplingEvent<int>(
+      1000, [&]() { return next++; }, 10,
+      [&](const int* samples, size_t count) {
+        received.insert(received.end(), samples, samples + count);
+        if (last_batch != samples) {
+          batches.push_back(samples);
+        }
+        last_batch = samples;
+      },
+      1, false, 3);
+  event->add(&loop);
+
+  // three batches fill up, the other 20 samples are dropped
+  sampleFor(50);
+  CHECK_EQ(event->getDroppedCount(), 20u);
+  loop.tick();
+  CHECK_EQ(received.size(), 30u);
+  for (int i = 0; i < 30; i++) {
+    CHECK_EQ(received[i], i);
+  }
+  CHECK_EQ(batches.size(), 3u);
+  CHECK(batches[1] == batches[0] + 10);
+  CHECK(batches[2] == batches[1] + 10);
+
+  // the ring wraps around to the first batch
+  received.clear();
+  sampleFor(10);
+  loop.tick();
+  CHECK_EQ(received.size(), 10u);
+  CHECK_EQ(received[0], 50);
+  CHECK_EQ(received[9], 59);
+  CHECK(last_batch == batches[0]);
+  CHECK_EQ(event->getDroppedCount(), 20u);
+  event->remove(&loop);
+  host::waitForTimers();
+  loop.tick();
+}
+
+void testDecimation() {
+  host::useManualClock(1000000);
+  EventLoop loop;
+  int next = 0;
+  std::vector<int> first;
+  SamplingEvent<int>* kept = loop.onSamplingMicros<int>(
+      1000, [&]() { return next++; }, 2,
+      [&](const int* samples, size_t count) {
+        first.insert(first.end(), samples, samples + count);
+      },
+      4);
+  sampleFor(16);
+  loop.tick();
+  kept->remove(&loop);
+  host::waitForTimers();
+  CHECK_EQ(first.size(), 4u);
+  CHECK_EQ(first[0], 0);
+  CHECK_EQ(first[1], 4);
+  CHECK_EQ(first[3], 12);
+
+  float value = 0;
+  std::vector<float> averaged;
+  SamplingEvent<float>* mean = loop.onSamplingMicros<float>(
+      1000, [&]() { return value += 1; }, 2,
+      [&](const float* samples, size_t count) {
+        averaged.insert(averaged.end(), samples, samples + count);
+      },
+      4, true);
+  sampleFor(8);
+  loop.tick();
+  mean->remove(&loop);
+  host::waitForTimers();
+  loop.tick();
+  CHECK_EQ(averaged.size(), 2u);
+  CHECK_EQ(averaged[0], 2.5f);
+  CHECK_EQ(averaged[1], 6.5f);
+}
+
+}  // namespace
+
+int main() {
+  testBatches();
+  testHandoff();
+  testDecimation();
+  printf("sampling ok\n");
+  return 0;
+}
@@ -0,0 +1,132 @@
+// Schedule snapshots round-tripped between two event loops, as across deep
+// sleep.
+
+#include <vector>
+
+#include "ReactESP.h"
+#include "host.h"
+#include "host_test.h"
+
+using namespace reactesp;
+
+namespace {
+
+const int64_t kStart = 1000000;
+const int64_t kWake = 50000000;
+const uint64_t kSleepUs = 1000000;
+
+std::vector<uint8_t> takeSnapshot(EventLoop& loop) {
+  const size_t size = loop.snapshotSchedule(nullptr, 0);
+  std::vector<uint8_t> blob(size);
+  // too small a buffer
+  CHECK_EQ(loop.snapshotSchedule(blob.data(), size - 1), 0);
+  CHECK_EQ(loop.snapshotSchedule(blob.data(), size), size);
+  return blob;
+}
+
+void testRoundTrip() {
+  host::useManualClock(kStart);
+  std::vector<uint8_t> blob;
+  uint64_t timed_count;
+  uint64_t tick_count;
+  {
+    EventLoop loop;
+    loop.onRepeat(100, []() {})->setId(1);
+    loop.onRepeat(30, []() {})->setId(2);
+    loop.onDelay(500, []() {})->setId(3);
+    // not included
+    loop.onRepeat(10, []() {});
+    host::advance(40000);
+    loop.tick();
+    timed_count = loop.getTimedEventCount();
+    tick_count = loop.getTickCount();
+    blob = takeSnapshot(loop);
+  }
+
+  host::setTime(kWake);
+  EventLoop loop;
+  RepeatEvent* slow = loop.onRepeat(100, []() {});
+  slow->setId(1);
+  RepeatEvent* fast = loop.onRepeat(30, []() {});
+  fast->setId(2);
+  DelayEvent* delay = loop.onDelay(500, []() {});
+  delay->setId(3);
+  // the interval has changed: not restored
+  RepeatEvent* changed = loop.onRepeat(50, []() {});
+  changed->setId(4);
+  loop.tick();
+  loop.tick();
+
+  CHECK_EQ(loop.restoreSchedule(blob.data(), blob.size(), kSleepUs), 3);
+  // 60 ms were left of the 100 ms period, 20 ms of the 30 ms one
+  CHECK_EQ(slow->getTriggerTimeMicros(), kWake + 60000);
+  CHECK_EQ(fast->getTriggerTimeMicros(), kWake + 10000);
+  // overdue
+  CHECK_EQ(delay->getTriggerTimeMicros(), kWake);
+  CHECK_EQ(changed->getTriggerTimeMicros(), kWake + 50000);
+
+  // the counters are set, not added to
+  CHECK_EQ(loop.getTimedEventCount(), timed_count);
+  CHECK_EQ(loop.getTickCount(), tick_count);
+  CHECK_EQ(loop.restoreSchedule(blob.data(), blob.size(), kSleepUs), 3);
+  CHECK_EQ(loop.getTimedEventCount(), timed_count);
+  CHECK_EQ(loop.getTickCount(), tick_count);
+
+  // the restored events run in the new phase
+  host::setTime(kWake + 10000);
+  loop.tick();
+  CHECK_EQ(fast->getTriggerTimeMicros(), kWake + 40000);
+}
+
+// Events sharing an id are each restored from their own entry
+void testDuplicateIds() {
+  host::useManualClock(kStart);
+  std::vector<uint8_t> blob;
+  {
+    EventLoop loop;
+    loop.onRepeat(100, []() {})->setId(7);
+    host::advance(25000);
+    loop.onRepeat(100, []() {})->setId(7);
+    blob = takeSnapshot(loop);
+  }
+
+  host::setTime(kWake);
+  EventLoop loop;
+  RepeatEvent* first = loop.onRepeat(100, []() {});
+  first->setId(7);
+  RepeatEvent* second = loop.onRepeat(100, []() {});
+  second->setId(7);
+  CHECK_EQ(loop.restoreSchedule(blob.data(), blob.size(), 0), 2);
+  uint64_t a = first->getTriggerTimeMicros();
+  uint64_t b = second->getTriggerTimeMicros();
+  if (a > b) {
+    std::swap(a, b);
+  }
+  CHECK_EQ(a, kWake + 75000);
+  CHECK_EQ(b, kWake + 100000);
+
+  // a third event with the id has no entry left
+  RepeatEvent* third = loop.onRepeat(100, []() {});
+  third->setId(7);
+  CHECK_EQ(loop.restoreSchedule(blob.data(), blob.size(), 0), 2);
+}
+
+void testInvalid() {
+  EventLoop loop;
+  std::vector<uint8_t> blob = takeSnapshot(loop);
+  CHECK_EQ(loop.restoreSchedule(blob.data(), blob.size(), 0), 0);
+  CHECK_EQ(loop.restoreSchedule(nullptr, 0, 0), -1);
+  CHECK_EQ(loop.restoreSchedule(blob.data(), blob.size() - 1, 0), -1);
+  blob[0] ^= 0xff;
+  CHECK_EQ(loop.restoreSchedule(blob.data(), blob.size(), 0), -1);
+}
+
+}  // namespace
+
+int main() {
+  testRoundTrip();
+  testDuplicateIds();
+  testInvalid();
+  printf("snapshot ok\n");
+  return 0;
+}
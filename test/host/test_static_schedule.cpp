@@ -0,0 +1,79 @@
+// StaticSchedule constants, slot masks and dispatch over the hyperperiod.
+
+#include "ReactESP.h"
+#include "host.h"
+#include "host_test.h"
+
+using namespace reactesp;
+
+namespace {
+
+int sensor_runs = 0;
+int filter_runs = 0;
+int publish_runs = 0;
+uint64_t last_filter_time = 0;
+
+void readSensors() { sensor_runs++; }
+
+void runFilter() {
+  // the sensors are read earlier in the same slot
+  CHECK_EQ(sensor_runs % 2, 0);
+  filter_runs++;
+  last_filter_time = micros64();
+}
+
+void publish() { publish_runs++; }
+
+}  // namespace
+
+constexpr StaticTask kTasks[] = {
+    {10, 0, readSensors},
+    {20, 10, runFilter},
+    {1000, 0, publish},
+};
+using Schedule = REACTESP_STATIC_SCHEDULE(kTasks);
+
+static_assert(Schedule::kBasePeriod == 10, "base period");
+static_assert(Schedule::kHyperperiod == 1000, "hyperperiod");
+static_assert(Schedule::kSlots == 100, "slots");
+
+// the hyperperiod of coprime intervals near 2^16 does not fit 32 bits
+constexpr StaticTask kCoprime[] = {
+    {65537, 0, publish},
+    {65539, 0, publish},
+};
+static_assert(static_schedule_detail::hyperperiod(kCoprime) > UINT32_MAX,
+              "saturated hyperperiod");
+
+namespace {
+
+void testSlotMasks() {
+  CHECK_EQ(Schedule::slotMask(0), 0x5u);
+  CHECK_EQ(Schedule::slotMask(1), 0x3u);
+  CHECK_EQ(Schedule::slotMask(2), 0x1u);
+  CHECK_EQ(Schedule::slotMask(99), 0x3u);
+}
+
+void testRuns() {
+  host::useManualClock(1000000);
+  EventLoop loop;
+  loop.onStaticSchedule<Schedule>();
+  for (int i = 0; i < 2000; i++) {
+    host::advance(1000);
+    loop.tick();
+  }
+  CHECK_EQ(sensor_runs, 200);
+  CHECK_EQ(filter_runs, 100);
+  CHECK_EQ(publish_runs, 2);
+  // the filter runs in odd slots, the last one ending at 2000 ms
+  CHECK_EQ(last_filter_time, 1000000 + 2000000);
+}
+
+}  // namespace
+
+int main() {
+  testSlotMasks();
+  testRuns();
+  printf("static schedule ok\n");
+  return 0;
+}
@@ -0,0 +1,126 @@
+// StreamEvent in polling and notify-driven mode.
+
+#include <chrono>
+#include <thread>
+
+#include "ReactESP.h"
+#include "fake_stream.h"
+#include "host.h"
+#include "host_test.h"
+
+using namespace reactesp;
+
+namespace {
+
+int64_t elapsedMs(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+void testPolling() {
+  EventLoop loop;
+  FakeStream stream;
+  int bytes = 0;
+  loop.onAvailable(stream, [&]() {
+    while (stream.read() >= 0) {
+      bytes++;
+    }
+  });
+  loop.tick();
+  CHECK_EQ(bytes, 0);
+  stream.put(2);
+  loop.tick();
+  CHECK_EQ(bytes, 2);
+}
+
+// Input is only checked after notify(); a callback that reads one byte at
+// a time is called again until the input is consumed.
+void testNotifyDriven() {
+  EventLoop loop;
+  FakeStream stream;
+  int calls = 0;
+  StreamEvent* event = loop.onAvailable(stream, [&]() {
+    calls++;
+    stream.read();
+  });
+  event->setNotifyDriven(true);
+  CHECK(event->isNotifyDriven());
+  // the initial check after switching modes
+  loop.tick();
+  CHECK_EQ(calls, 0);
+
+  stream.put(1);
+  loop.tick();
+  CHECK_EQ(calls, 0);
+  const uint64_t available_calls = stream.available_calls;
+  for (int i = 0; i < 10; i++) {
+    loop.tick();
+  }
+  // not polled without a notification
+  CHECK_EQ(stream.available_calls, available_calls);
+
+  event->notify();
+  loop.tick();
+  CHECK_EQ(calls, 1);
+
+  stream.put(3);
+  event->notify();
+  for (int i = 0; i < 5; i++) {
+    loop.tick();
+  }
+  CHECK_EQ(calls, 4);
+  CHECK_EQ(stream.pending.load(), 0);
+
+  // back to polling
+  event->setNotifyDriven(false);
+  stream.put(1);
+  loop.tick();
+  CHECK_EQ(calls, 5);
+
+  event->remove(&loop);
+}
+
+// A notify-driven stream does not keep tickBlocking() from blocking, and
+// notify() from another task wakes the loop up.
+void testNotifyWakesBlockingLoop() {
+  EventLoop loop;
+  FakeStream stream;
+  int bytes = 0;
+  StreamEvent* event = loop.onAvailable(stream, [&]() {
+    while (stream.read() >= 0) {
+      bytes++;
+    }
+  });
+  event->setNotifyDriven(true);
+  loop.tick();
+
+  auto start = std::chrono::steady_clock::now();
+  loop.tickBlocking(50);
+  CHECK(elapsedMs(start) >= 40);
+
+  std::thread driver([&stream, event]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    stream.put(4);
+    event->notify();
+  });
+  start = std::chrono::steady_clock::now();
+  while (bytes == 0) {
+    loop.tickBlocking(5000);
+  }
+  const int64_t waited = elapsedMs(start);
+  driver.join();
+  CHECK_EQ(bytes, 4);
+  CHECK(waited >= 10);
+  CHECK(waited < 2000);
+}
+
+}  // namespace
+
+int main() {
+  testPolling();
+  testNotifyDriven();
+  testNotifyWakesBlockingLoop();
+  printf("stream event ok\n");
+  return 0;
+}
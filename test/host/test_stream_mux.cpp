@@ -0,0 +1,144 @@
+// StreamMuxEvent polling backoff, service order and streams added from a
+// callback.
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ReactESP.h"
+#include "fake_stream.h"
+#include "host_test.h"
+
+using namespace reactesp;
+
+namespace {
+
+// Ticks on which the stream was polled, out of `ticks`
+std::vector<int> pollTicks(EventLoop& loop, FakeStream& stream, int ticks) {
+  std::vector<int> polled;
+  for (int i = 1; i <= ticks; i++) {
+    const uint64_t before = stream.available_calls;
+    loop.tick();
+    if (stream.available_calls != before) {
+      polled.push_back(i);
+    }
+  }
+  return polled;
+}
+
+void drain(FakeStream& stream) {
+  while (stream.read() >= 0) {
+  }
+}
+
+void testBackoff() {
+  EventLoop loop;
+  FakeStream stream;
+  int calls = 0;
+  StreamMuxEvent* mux = loop.onAvailableMux(8);
+  mux->addStream(stream, [&]() {
+    calls++;
+    drain(stream);
+  });
+
+  // the interval doubles up to the maximum
+  std::vector<int> polled = pollTicks(loop, stream, 31);
+  const std::vector<int> backoff = {1, 3, 7, 15, 23, 31};
+  CHECK(polled == backoff);
+
+  // input is picked up by the next scheduled poll; the stream is then
+  // polled on every tick while it has input, and backs off again from 2
+  stream.put(1);
+  polled = pollTicks(loop, stream, 11);
+  CHECK_EQ(calls, 1);
+  const std::vector<int> reset = {8, 9, 11};
+  CHECK(polled == reset);
+
+  // after the reset, idle input waits at most 4 ticks
+  stream.put(1);
+  polled = pollTicks(loop, stream, 4);
+  CHECK_EQ(calls, 2);
+  CHECK(polled == std::vector<int>{4});
+  CHECK_EQ(mux->getStreamCount(), 1u);
+}
+
+void testActiveFirst() {
+  EventLoop loop;
+  FakeStream a;
+  FakeStream b;
+  std::string order;
+  StreamMuxEvent* mux = loop.onAvailableMux(1);
+  mux->addStream(a, [&]() {
+    order += 'a';
+    drain(a);
+  });
+  mux->addStream(b, [&]() {
+    order += 'b';
+    drain(b);
+  });
+
+  loop.tick();
+  CHECK(order.empty());
+  b.put(1);
+  loop.tick();
+  CHECK(order == "b");
+
+  // b had input on the previous pass and is served before a
+  order.clear();
+  a.put(1);
+  b.put(1);
+  loop.tick();
+  CHECK(order == "ba");
+
+  // both were active: table order
+  order.clear();
+  a.put(1);
+  b.put(1);
+  loop.tick();
+  CHECK(order == "ab");
+}
+
+void testAddFromCallback() {
+  EventLoop loop;
+  std::vector<std::unique_ptr<FakeStream>> streams;
+  int added_calls = 0;
+  StreamMuxEvent* mux = loop.onAvailableMux(4);
+  FakeStream first;
+  // every callback adds streams with pending input, growing the table
+  // while it is being iterated
+  mux->addStream(first, [&]() {
+    drain(first);
+    for (int i = 0; i < 16; i++) {
+      streams.emplace_back(new FakeStream());
+      FakeStream* stream = streams.back().get();
+      stream->put(1);
+      mux->addStream(*stream, [stream, &added_calls]() {
+        added_calls++;
+        drain(*stream);
+      });
+    }
+  });
+  first.put(1);
+  loop.tick();
+  CHECK_EQ(mux->getStreamCount(), 17u);
+  CHECK_EQ(added_calls, 0);
+  loop.tick();
+  CHECK_EQ(added_calls, 16);
+  // first has backed off to every other tick
+  first.put(1);
+  loop.tick();
+  loop.tick();
+  CHECK_EQ(mux->getStreamCount(), 33u);
+  loop.tick();
+  CHECK_EQ(added_calls, 32);
+}
+
+}  // namespace
+
+int main() {
+  testBackoff();
+  testActiveFirst();
+  testAddFromCallback();
+  printf("stream mux ok\n");
+  return 0;
+}
@@ -0,0 +1,163 @@
+// TaskGraph ordering, cycle detection, graphs with more edges than a 16-bit
+// offset can index and restarting a graph when it completes.
+
+#include <vector>
+
+#include "ReactESP.h"
+#include "host_test.h"
+#include "task_graph.h"
+
+using namespace reactesp;
+
+namespace {
+
+void waitForCompletion(EventLoop& loop, TaskGraph& graph) {
+  for (int i = 0; i < 1000 && graph.isRunning(); i++) {
+    loop.tick();
+  }
+  CHECK(!graph.isRunning());
+}
+
+void runToCompletion(EventLoop& loop, TaskGraph& graph) {
+  CHECK(graph.run());
+  waitForCompletion(loop, graph);
+}
+
+void testOrder() {
+  EventLoop loop;
+  TaskGraph graph(&loop);
+  std::vector<int> order;
+  const int a = graph.addNode([&]() { order.push_back(0); });
+  const int b = graph.addNode([&]() { order.push_back(1); }, true);
+  const int c = graph.addNode([&]() { order.push_back(2); });
+  CHECK(graph.addDependency(c, b));
+  CHECK(graph.addDependency(b, a));
+  CHECK(graph.build());
+  CHECK(graph.run());
+  for (int i = 0; i < 5; i++) {
+    loop.tick();
+  }
+  // b is asynchronous and has not completed
+  CHECK_EQ(order.size(), 2);
+  CHECK(graph.complete(b));
+  waitForCompletion(loop, graph);
+  CHECK_EQ(order.size(), 3);
+  CHECK_EQ(order[0], 0);
+  CHECK_EQ(order[1], 1);
+  CHECK_EQ(order[2], 2);
+}
+
+void testCycle() {
+  EventLoop loop;
+  TaskGraph graph(&loop);
+  const int a = graph.addNode([]() {});
+  const int b = graph.addNode([]() {});
+  graph.addDependency(a, b);
+  graph.addDependency(b, a);
+  CHECK(!graph.build());
+  CHECK(!graph.run());
+}
+
+// Two fully connected layers of 300 nodes have 90000 edges
+void testManyEdges() {
+  const int kLayer = 300;
+  EventLoop loop;
+  TaskGraph graph(&loop);
+  int first_done = 0;
+  int second_done = 0;
+  bool ordered = true;
+  std::vector<int> first;
+  std::vector<int> second;
+  for (int i = 0; i < kLayer; i++) {
+    first.push_back(graph.addNode([&]() { first_done++; }));
+  }
+  for (int i = 0; i < kLayer; i++) {
+    second.push_back(graph.addNode([&]() {
+      ordered = ordered && first_done == kLayer;
+      second_done++;
+    }));
+  }
+  int sink_runs = 0;
+  const int sink = graph.addNode([&]() {
+    ordered = ordered && second_done == kLayer;
+    sink_runs++;
+  });
+  for (int s : second) {
+    for (int f : first) {
+      CHECK(graph.addDependency(s, f));
+    }
+    CHECK(graph.addDependency(sink, s));
+  }
+  // more dependencies on one node than a 16-bit counter holds
+  const int root = graph.addNode([]() {});
+  for (int i = 0; i < 70000; i++) {
+    graph.addDependency(first[0], root);
+  }
+  CHECK(graph.build());
+  runToCompletion(loop, graph);
+  CHECK(ordered);
+  CHECK_EQ(first_done, kLayer);
+  CHECK_EQ(second_done, kLayer);
+  CHECK_EQ(sink_runs, 1);
+  CHECK_EQ(graph.getNodeStats(sink).runs, 1);
+  runToCompletion(loop, graph);
+  CHECK_EQ(sink_runs, 2);
+}
+
+// A completion callback that restarts the graph: the new execution starts
+// on the next tick instead of running inside the current one
+void testRestartFromCompletion() {
+  const int kLimit = 100000;
+  EventLoop loop;
+  TaskGraph graph(&loop);
+  int a_runs = 0;
+  int b_runs = 0;
+  int completions = 0;
+  const int a = graph.addNode([&]() { a_runs++; });
+  const int b = graph.addNode([&]() { b_runs++; });
+  CHECK(graph.addDependency(b, a));
+  CHECK(graph.build());
+  graph.onComplete([&]() {
+    // bounded so that a regression fails instead of hanging
+    if (++completions < kLimit) {
+      CHECK(graph.run());
+    }
+  });
+  CHECK(graph.run());
+  for (int i = 0; i < 10; i++) {
+    loop.tick();
+    // a and b run on separate ticks
+    CHECK(completions <= (i + 1) / 2);
+  }
+  CHECK_EQ(completions, 5);
+  CHECK_EQ(b_runs, 5);
+  CHECK_EQ(a_runs, 5);
+  CHECK(graph.isRunning());
+
+  // the same with a single node, which completes in the tick it runs
+  TaskGraph single(&loop);
+  int single_completions = 0;
+  single.addNode([]() {});
+  CHECK(single.build());
+  single.onComplete([&]() {
+    if (++single_completions < kLimit) {
+      CHECK(single.run());
+    }
+  });
+  CHECK(single.run());
+  for (int i = 0; i < 10; i++) {
+    loop.tick();
+  }
+  CHECK_EQ(single_completions, 10);
+}
+
+}  // namespace
+
+int main() {
+  testOrder();
+  testCycle();
+  testManyEdges();
+  testRestartFromCompletion();
+  printf("task graph ok\n");
+  return 0;
+}
@@ -0,0 +1,121 @@
+// TimedEventQueue::push_range on both of its paths and the dispatch
+// order of events added through a TimedEventBatch.
+
+#include <algorithm>
+#include <vector>
+
+#include "ReactESP.h"
+#include "host.h"
+#include "host_test.h"
+
+using namespace reactesp;
+
+namespace {
+
+uint32_t lcg_state = 12345;
+
+uint32_t nextDelay() {
+  lcg_state = lcg_state * 1103515245 + 12345;
+  return (lcg_state >> 8) % 100000;
+}
+
+std::vector<TimedEvent*> makeEvents(size_t count) {
+  std::vector<TimedEvent*> events;
+  for (size_t i = 0; i < count; i++) {
+    events.push_back(new DelayEvent((uint64_t)nextDelay(), []() {}));
+  }
+  return events;
+}
+
+// Pop all events, checking that they come out in trigger time order
+void checkPopOrder(TimedEventQueue& queue, size_t expected) {
+  std::vector<TimedEvent*>& c = queue.container();
+  CHECK(std::is_heap(c.begin(), c.end(), TriggerTimeCompare()));
+  size_t popped = 0;
+  uint64_t last = 0;
+  while (!queue.empty()) {
+    TimedEvent* event = queue.top();
+    queue.pop();
+    CHECK(event->getTriggerTimeMicros() >= last);
+    last = event->getTriggerTimeMicros();
+    delete event;
+    popped++;
+  }
+  CHECK_EQ(popped, expected);
+}
+
+void testPushRange() {
+  host::useManualClock(1000000);
+
+  // into an empty queue: appended and heapified
+  TimedEventQueue queue;
+  std::vector<TimedEvent*> events = makeEvents(200);
+  queue.push_range(events.begin(), events.end());
+  checkPopOrder(queue, 200);
+
+  // a range larger than the queue: heapified with the existing events
+  events = makeEvents(50);
+  queue.push_range(events.begin(), events.end());
+  events = makeEvents(80);
+  queue.push_range(events.begin(), events.end());
+  checkPopOrder(queue, 130);
+
+  // a range smaller than the queue: pushed one by one
+  events = makeEvents(100);
+  queue.push_range(events.begin(), events.end());
+  events = makeEvents(10);
+  queue.push_range(events.begin(), events.end());
+  CHECK_EQ(queue.size(), 110u);
+  checkPopOrder(queue, 110);
+
+  // an empty range
+  queue.push_range(events.begin(), events.begin());
+  CHECK(queue.empty());
+}
+
+// Events added one by one and through batches run in trigger time order
+void testBatchOrder() {
+  host::useManualClock(1000000);
+  EventLoop loop;
+  std::vector<uint32_t> fired;
+  auto record = [&fired](uint32_t delay) {
+    return [&fired, delay]() { fired.push_back(delay); };
+  };
+  for (uint32_t delay = 5; delay <= 200; delay += 5) {
+    loop.onDelay(delay, record(delay));
+  }
+  {
+    // large batch, heapified with the queue
+    TimedEventBatch batch(&loop, 60);
+    for (uint32_t delay = 3; delay <= 180; delay += 3) {
+      batch.onDelay(delay, record(delay));
+    }
+    CHECK_EQ(batch.size(), 60u);
+    batch.commit();
+    CHECK_EQ(batch.size(), 0u);
+    CHECK_EQ(loop.getTimedEventQueueSize(), 100u);
+
+    // small batch, pushed one by one, committed by the destructor
+    batch.onDelay(7, record(7));
+    batch.onDelay(101, record(101));
+    batch.onRepeat(250, record(250));
+  }
+  CHECK_EQ(loop.getTimedEventQueueSize(), 103u);
+
+  for (int i = 0; i < 300; i++) {
+    host::advance(1000);
+    loop.tick();
+  }
+  CHECK_EQ(fired.size(), 103u);
+  CHECK(std::is_sorted(fired.begin(), fired.end()));
+  CHECK_EQ(fired.back(), 250u);
+}
+
+}  // namespace
+
+int main() {
+  testPushRange();
+  testBatchOrder();
+  printf("timed batch ok\n");
+  return 0;
+}
@@ -0,0 +1,135 @@
+// WritableEvent space threshold, enable/disable, disabling from the
+// callback and blocking of tickBlocking() while disabled.
+
+#include <chrono>
+
+#include "ReactESP.h"
+#include "fake_stream.h"
+#include "host_test.h"
+
+using namespace reactesp;
+
+namespace {
+
+// Stream with a settable amount of free transmit space
+class SpaceStream : public FakeStream {
+ public:
+  int availableForWrite() override { return space; }
+  int space = 0;
+};
+
+int64_t elapsedMs(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+void testThreshold() {
+  EventLoop loop;
+  SpaceStream stream;
+  int calls = 0;
+  loop.onWritable(stream, 16, [&]() { calls++; });
+  stream.space = 15;
+  loop.tick();
+  CHECK_EQ(calls, 0);
+  // level-triggered: called on every tick while there is space
+  stream.space = 16;
+  loop.tick();
+  loop.tick();
+  CHECK_EQ(calls, 2);
+  stream.space = 0;
+  loop.tick();
+  CHECK_EQ(calls, 2);
+}
+
+void testEnableDisable() {
+  EventLoop loop;
+  SpaceStream stream;
+  stream.space = 64;
+  int calls = 0;
+  WritableEvent* event = loop.onWritable(stream, 1, [&]() { calls++; });
+  CHECK_EQ(loop.getUntimedEventQueueSize(), 1);
+
+  event->disable();
+  CHECK(!event->isEnabled());
+  CHECK_EQ(loop.getUntimedEventQueueSize(), 0);
+  loop.tick();
+  CHECK_EQ(calls, 0);
+  event->disable();
+
+  event->enable();
+  event->enable();
+  CHECK(event->isEnabled());
+  CHECK_EQ(loop.getUntimedEventQueueSize(), 1);
+  loop.tick();
+  CHECK_EQ(calls, 1);
+
+  // removing a disabled event deletes it
+  event->disable();
+  event->remove(&loop);
+  CHECK_EQ(loop.getUntimedEventQueueSize(), 0);
+  loop.tick();
+  CHECK_EQ(calls, 1);
+}
+
+// Disabling from the callback does not skip the following events
+void testDisableFromCallback() {
+  EventLoop loop;
+  SpaceStream stream;
+  stream.space = 64;
+  int chunks = 3;
+  int writes = 0;
+  int ticks = 0;
+  WritableEvent* event = nullptr;
+  event = loop.onWritable(stream, 1, [&]() {
+    writes++;
+    if (--chunks == 0) {
+      event->disable();
+    }
+  });
+  loop.onTick([&]() { ticks++; });
+  for (int i = 0; i < 5; i++) {
+    loop.tick();
+  }
+  CHECK_EQ(writes, 3);
+  CHECK_EQ(ticks, 5);
+  CHECK_EQ(loop.getUntimedEventQueueSize(), 1);
+
+  chunks = 1;
+  event->enable();
+  loop.tick();
+  loop.tick();
+  CHECK_EQ(writes, 4);
+  CHECK_EQ(ticks, 7);
+}
+
+void testBlocking() {
+  EventLoop loop;
+  SpaceStream stream;
+  stream.space = 64;
+  int calls = 0;
+  WritableEvent* event = loop.onWritable(stream, 1, [&]() { calls++; });
+
+  // an enabled event is polled and keeps the loop from blocking
+  auto start = std::chrono::steady_clock::now();
+  loop.tickBlocking(200);
+  CHECK(elapsedMs(start) < 100);
+  CHECK_EQ(calls, 1);
+
+  event->disable();
+  start = std::chrono::steady_clock::now();
+  loop.tickBlocking(50);
+  CHECK(elapsedMs(start) >= 40);
+  CHECK_EQ(calls, 1);
+}
+
+}  // namespace
+
+int main() {
+  testThreshold();
+  testEnableDisable();
+  testDisableFromCallback();
+  testBlocking();
+  printf("writable ok\n");
+  return 0;
+}